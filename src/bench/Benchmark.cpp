@@ -0,0 +1,82 @@
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include "json.hpp"
+#include "Benchmark.h"
+
+using json = nlohmann::json;
+
+Benchmark::Benchmark(int repetitions, const string &filter) {
+  this->repetitions = repetitions > 0? repetitions: 1;
+  this->filter = filter;
+}
+
+bool Benchmark::isEnabled(const string &name) {
+  return filter.empty() || name.find(filter) != string::npos;
+}
+
+void Benchmark::report(ostream &out) {
+  out << left << setw(48) << "Benchmark" << right << setw(14) << "Iterations"
+      << setw(14) << "Median(ns)" << setw(14) << "Min(ns)" << setw(14) << "Max(ns)"
+      << setw(16) << "Items/s" << endl;
+  for (size_t i = 0; i < results.size(); i++) {
+    vector<double> samples = results[i].samples;
+    sort(samples.begin(), samples.end());
+    double median = Benchmark::median(samples);
+    out << left << setw(48) << results[i].name << right << setw(14) << results[i].iterations
+        << fixed << setprecision(2) << setw(14) << median << setw(14) << samples.front()
+        << setw(14) << samples.back() << setw(16) << setprecision(0) << results[i].items * 1e9 / median
+        << endl;
+  }
+}
+
+void Benchmark::writeJson(ostream &out) {
+  json benchmarks = json::array();
+  for (size_t i = 0; i < results.size(); i++) {
+    const vector<double> &samples = results[i].samples;
+    json result;
+    result["name"] = results[i].name;
+    result["iterations"] = results[i].iterations;
+    result["items"] = results[i].items;
+    result["median_ns"] = median(samples);
+    result["min_ns"] = *min_element(samples.begin(), samples.end());
+    result["max_ns"] = *max_element(samples.begin(), samples.end());
+    result["samples_ns"] = samples;
+    benchmarks.push_back(result);
+  }
+  json report;
+  report["repetitions"] = repetitions;
+  report["benchmarks"] = benchmarks;
+  out << report.dump(2) << endl;
+}
+
+bool Benchmark::loadJson(const string &path, vector<Result> &results) {
+  ifstream in(path.c_str());
+  if (!in) {
+    return false;
+  }
+  try {
+    json report = json::parse(in);
+    results.clear();
+    for (const json &benchmark: report["benchmarks"]) {
+      Result result;
+      result.name = benchmark["name"].get<string>();
+      result.iterations = benchmark["iterations"].get<long long>();
+      result.items = benchmark["items"].get<long long>();
+      result.samples = benchmark["samples_ns"].get<vector<double> >();
+      if (result.samples.empty()) {
+        return false;
+      }
+      results.push_back(result);
+    }
+  } catch (const exception &) {
+    return false;
+  }
+  return true;
+}
+
+double Benchmark::median(vector<double> samples) {
+  sort(samples.begin(), samples.end());
+  return samples.size() % 2? samples[samples.size() / 2]:
+      (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2;
+}
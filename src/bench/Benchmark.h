@@ -0,0 +1,122 @@
+#ifndef _BENCH_BENCHMARK_H_
+#define _BENCH_BENCHMARK_H_
+
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * Prevent the compiler from optimizing away a value computed by a benchmark
+ * @param value the value to keep
+ */
+template<typename T> inline void doNotOptimize(T const &value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/**
+ * Benchmark runs microbenchmarks and collects their timings. Every benchmark is run a number of
+ * repetitions, each repetition calls the benchmark function a fixed number of iterations, and
+ * records the mean time per iteration, so that results can be compared statistically.
+ */
+class Benchmark {
+public:
+  /**
+   * Timings of a benchmark
+   */
+  struct Result {
+    string name;            // name of the benchmark
+    long long iterations;   // iterations per repetition
+    long long items;        // items processed per iteration
+    vector<double> samples; // nanoseconds per iteration of each repetition
+  };
+
+private:
+  // number of repetitions
+  int repetitions;
+  // only benchmarks with names containing the filter are run
+  string filter;
+  // results of the benchmarks run so far
+  vector<Result> results;
+
+public:
+  /**
+   * Constructor
+   * @param repetitions number of repetitions of each benchmark
+   * @param filter run only the benchmarks whose name contain the filter, empty to run all
+   */
+  Benchmark(int repetitions = 5, const string &filter = "");
+
+  /**
+   * Return true if the benchmark with the given name is to be run
+   * @param name name of the benchmark
+   */
+  bool isEnabled(const string &name);
+
+  /**
+   * Run a benchmark
+   * @param name name of the benchmark
+   * @param iterations number of times to call fn in each repetition
+   * @param fn the function to measure, it takes no argument
+   * @param items number of items, e.g. controls, processed by each call to fn
+   */
+  template<typename F> void run(const string &name, long long iterations, F fn, long long items = 1) {
+    if (!isEnabled(name)) {
+      return;
+    }
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.items = items;
+    // warm up caches and branch predictors
+    for (long long i = 0; i < iterations / 10 + 1; i++) {
+      fn();
+    }
+    for (int r = 0; r < repetitions; r++) {
+      chrono::steady_clock::time_point start = chrono::steady_clock::now();
+      for (long long i = 0; i < iterations; i++) {
+        fn();
+      }
+      chrono::steady_clock::time_point end = chrono::steady_clock::now();
+      result.samples.push_back(chrono::duration<double, nano>(end - start).count() / iterations);
+    }
+    results.push_back(result);
+  }
+
+  /**
+   * Return the results of the benchmarks run so far
+   */
+  const vector<Result> &getResults() { return results;}
+
+  /**
+   * Write a human readable report of the results
+   * @param out the stream to write to
+   */
+  void report(ostream &out);
+
+  /**
+   * Write the results as JSON, an object with the number of repetitions and an array of the
+   * benchmarks, each with its name, iterations, items, median, min and max, and the nanoseconds
+   * per iteration of every repetition, so that runs can be compared with a stored baseline
+   * @param out the stream to write to
+   */
+  void writeJson(ostream &out);
+
+  /**
+   * Load results written by writeJson
+   * @param path the file path
+   * @param results receives the results
+   * @return true if successful
+   */
+  static bool loadJson(const string &path, vector<Result> &results);
+
+  /**
+   * Return the median of samples
+   * @param samples the samples, not empty
+   */
+  static double median(vector<double> samples);
+};
+
+#endif
@@ -0,0 +1,126 @@
+#include <math.h>
+#include <algorithm>
+#include "Comparison.h"
+
+Comparison::Comparison(double alpha, double threshold, int resamples, double confidence, unsigned seed):
+    alpha(alpha), threshold(threshold), resamples(resamples), confidence(confidence), generator(seed) {}
+
+void Comparison::setThreshold(const string &pattern, double threshold) {
+  thresholds.push_back(make_pair(pattern, threshold));
+}
+
+double Comparison::getThreshold(const string &name) const {
+  for (size_t i = 0; i < thresholds.size(); i++) {
+    if (name.find(thresholds[i].first) != string::npos) {
+      return thresholds[i].second;
+    }
+  }
+  return threshold;
+}
+
+void Comparison::bootstrap(const vector<double> &baseline, const vector<double> &candidate, double &low, double &high) {
+  uniform_int_distribution<size_t> pick_baseline(0, baseline.size() - 1);
+  uniform_int_distribution<size_t> pick_candidate(0, candidate.size() - 1);
+  vector<double> changes(resamples);
+  vector<double> a(baseline.size()), b(candidate.size());
+  for (int r = 0; r < resamples; r++) {
+    for (size_t i = 0; i < a.size(); i++) {
+      a[i] = baseline[pick_baseline(generator)];
+    }
+    for (size_t i = 0; i < b.size(); i++) {
+      b[i] = candidate[pick_candidate(generator)];
+    }
+    changes[r] = Benchmark::median(b) / Benchmark::median(a) - 1;
+  }
+  sort(changes.begin(), changes.end());
+  double tail = (1 - confidence) / 2;
+  low = changes[(size_t)(tail * (resamples - 1))];
+  high = changes[(size_t)((1 - tail) * (resamples - 1))];
+}
+
+double Comparison::mannWhitney(const vector<double> &a, const vector<double> &b) {
+  size_t n1 = a.size(), n2 = b.size(), n = n1 + n2;
+  // rank the pooled samples, ties get the mean of their ranks
+  vector<pair<double, int> > pooled;
+  for (size_t i = 0; i < n1; i++) pooled.push_back(make_pair(a[i], 0));
+  for (size_t i = 0; i < n2; i++) pooled.push_back(make_pair(b[i], 1));
+  sort(pooled.begin(), pooled.end());
+  double rank_sum = 0, tie_sum = 0;
+  for (size_t i = 0; i < n;) {
+    size_t j = i;
+    while (j < n && pooled[j].first == pooled[i].first) j++;
+    double rank = (i + 1 + j) / 2.0;
+    for (size_t k = i; k < j; k++) {
+      if (pooled[k].second == 0) rank_sum += rank;
+    }
+    double t = j - i;
+    tie_sum += t * t * t - t;
+    i = j;
+  }
+  // the number of pairs in which the sample of a is greater
+  double u = rank_sum - n1 * (n1 + 1) / 2.0;
+  double mean = n1 * n2 / 2.0;
+
+  if (tie_sum == 0 && n <= 40) {
+    // the exact distribution of U, count[i][k] is the number of orderings of i samples of a and
+    // j samples of b with U = k. The greatest sample of an ordering is either of a, greater than
+    // the j samples of b, or of b, which adds nothing to U, so the counts for j samples of b are
+    // those for j - 1 plus those of one sample of a less shifted by j
+    size_t max_u = n1 * n2;
+    vector<vector<double> > count(n1 + 1, vector<double>(max_u + 1, 0));
+    for (size_t i = 0; i <= n1; i++) count[i][0] = 1;
+    for (size_t j = 1; j <= n2; j++) {
+      for (size_t i = 1; i <= n1; i++) {
+        for (size_t k = j; k <= max_u; k++) {
+          count[i][k] += count[i - 1][k - j];
+        }
+      }
+    }
+    double total = 0, below = 0, above = 0;
+    for (size_t k = 0; k <= max_u; k++) {
+      total += count[n1][k];
+      if (k <= u) below += count[n1][k];
+      if (k >= u) above += count[n1][k];
+    }
+    return fmin(1, 2 * fmin(below, above) / total);
+  }
+
+  double variance = n1 * n2 / 12.0 * ((n + 1) - tie_sum / (n * (n - 1.0)));
+  if (variance <= 0) {
+    return 1;
+  }
+  // continuity correction
+  double z = (fabs(u - mean) - 0.5) / sqrt(variance);
+  return fmin(1, erfc(fmax(z, 0) / M_SQRT2));
+}
+
+double Comparison::minPValue(size_t n1, size_t n2) {
+  // 2 of the n1 + n2 choose n1 orderings are the most extreme
+  double orderings = 1;
+  for (size_t k = 1; k <= n1; k++) {
+    orderings = orderings * (n2 + k) / k;
+  }
+  return fmin(1, 2 / orderings);
+}
+
+Comparison::Outcome Comparison::compare(const Benchmark::Result &baseline, const Benchmark::Result &candidate) {
+  Outcome outcome;
+  outcome.name = baseline.name;
+  outcome.baseline = Benchmark::median(baseline.samples);
+  outcome.candidate = Benchmark::median(candidate.samples);
+  outcome.change = outcome.candidate / outcome.baseline - 1;
+  bootstrap(baseline.samples, candidate.samples, outcome.low, outcome.high);
+  outcome.p_value = mannWhitney(baseline.samples, candidate.samples);
+  outcome.threshold = getThreshold(baseline.name);
+  outcome.verdict = UNCHANGED;
+  if (minPValue(baseline.samples.size(), candidate.samples.size()) >= alpha) {
+    outcome.verdict = UNDECIDED;
+  } else if (outcome.p_value < alpha) {
+    if (outcome.change > outcome.threshold) {
+      outcome.verdict = REGRESSION;
+    } else if (outcome.change < -outcome.threshold) {
+      outcome.verdict = IMPROVEMENT;
+    }
+  }
+  return outcome;
+}
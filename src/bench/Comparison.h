@@ -0,0 +1,116 @@
+#ifndef _BENCH_COMPARISON_H_
+#define _BENCH_COMPARISON_H_
+
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "Benchmark.h"
+
+using namespace std;
+
+/**
+ * Comparison judges whether a benchmark got slower or faster between a baseline and a candidate
+ * run from the nanoseconds per iteration of their repetitions. The change is the ratio of the
+ * medians minus 1, with a bootstrap confidence interval from resampling the repetitions of both
+ * runs. The difference is significant if the two sided Mann-Whitney U test rejects that the
+ * repetitions of both runs come from the same distribution. The test is exact for small runs
+ * without ties, and uses the normal approximation with the tie correction otherwise.
+ * A change is a regression if it is significant and above the threshold of the benchmark, and an
+ * improvement if it is significant and below the negative threshold. With too few repetitions, no
+ * ordering of the repetitions is significant, e.g. 3 of each run have a least p-value of 0.1, so
+ * the comparison is undecided, whatever the change.
+ */
+class Comparison {
+public:
+  static const int REGRESSION = 1;
+  static const int IMPROVEMENT = -1;
+  static const int UNCHANGED = 0;
+  static const int UNDECIDED = 2;
+
+  /**
+   * The comparison of a benchmark
+   */
+  struct Outcome {
+    string name;       // name of the benchmark
+    double baseline;   // median nanoseconds per iteration of the baseline
+    double candidate;  // median nanoseconds per iteration of the candidate
+    double change;     // relative change of the median, positive if the candidate is slower
+    double low, high;  // confidence interval of the change
+    double p_value;    // p-value of the Mann-Whitney U test
+    double threshold;  // the threshold of the benchmark
+    int verdict;       // REGRESSION, IMPROVEMENT, UNCHANGED, or UNDECIDED for too few repetitions
+  };
+
+private:
+  // significance level of the test
+  double alpha;
+  // the threshold of the benchmarks with no threshold of their own
+  double threshold;
+  // the thresholds of the benchmarks whose names contain a pattern, the first match wins
+  vector<pair<string, double> > thresholds;
+  // number of bootstrap resamples
+  int resamples;
+  // confidence level of the interval
+  double confidence;
+  // the generator of the resamples
+  default_random_engine generator;
+
+  /**
+   * Compute the bootstrap confidence interval of the change of the median
+   * @param baseline the samples of the baseline
+   * @param candidate the samples of the candidate
+   * @param low receives the lower bound
+   * @param high receives the upper bound
+   */
+  void bootstrap(const vector<double> &baseline, const vector<double> &candidate, double &low, double &high);
+
+public:
+  /**
+   * Constructor
+   * @param alpha significance level of the test
+   * @param threshold relative change of the median above which a slower benchmark is a regression
+   * @param resamples number of bootstrap resamples
+   * @param confidence confidence level of the interval
+   * @param seed seed of the resamples, so that comparisons are repeatable
+   */
+  Comparison(double alpha = 0.05, double threshold = 0.05, int resamples = 2000, double confidence = 0.95, unsigned seed = 1);
+
+  /**
+   * Set the threshold of the benchmarks whose names contain a pattern, ahead of the patterns set later
+   * @param pattern the pattern
+   * @param threshold the threshold
+   */
+  void setThreshold(const string &pattern, double threshold);
+
+  /**
+   * Return the threshold of a benchmark
+   * @param name name of the benchmark
+   */
+  double getThreshold(const string &name) const;
+
+  /**
+   * Compare a benchmark
+   * @param baseline the results of the baseline
+   * @param candidate the results of the candidate
+   * @return the comparison
+   */
+  Outcome compare(const Benchmark::Result &baseline, const Benchmark::Result &candidate);
+
+  /**
+   * Return the least two sided p-value of the Mann-Whitney U test of two numbers of samples, that
+   * of the samples of one all below those of the other
+   * @param n1 number of the first samples
+   * @param n2 number of the second samples
+   */
+  static double minPValue(size_t n1, size_t n2);
+
+  /**
+   * Return the two sided p-value of the Mann-Whitney U test
+   * @param a the first samples
+   * @param b the second samples
+   */
+  static double mannWhitney(const vector<double> &a, const vector<double> &b);
+};
+
+#endif
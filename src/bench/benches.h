@@ -0,0 +1,68 @@
+#ifndef _BENCH_BENCHES_H_
+#define _BENCH_BENCHES_H_
+
+#include "Benchmark.h"
+
+/**
+ * Benchmark the sliding window quantile against sort based baselines
+ */
+void quantileBench(Benchmark &bench);
+
+/**
+ * Verify the Reducer operations against the standard algorithms, and benchmark them across
+ * window sizes
+ */
+void reducerBench(Benchmark &bench);
+
+/**
+ * Benchmark the PID bank against scalar PID and PIDController controllers
+ */
+void pidBankBench(Benchmark &bench);
+
+/**
+ * Benchmark the gain schedule lookup
+ */
+void gainScheduleBench(Benchmark &bench);
+
+/**
+ * Verify the speed curve against the speed target if chain it replaces, and benchmark them
+ */
+void speedCurveBench(Benchmark &bench);
+
+/**
+ * Benchmark every combination of the steering pipeline stages, and verify that each of them drives
+ * closed loop laps of the oval track without leaving it before benchmarking the laps
+ */
+void steeringBench(Benchmark &bench);
+
+/**
+ * Verify the track hierarchy against comparing all the segments, and benchmark them
+ */
+void trackBench(Benchmark &bench);
+
+/**
+ * Verify the moments of the batched normal generator, and benchmark it and noisy car steps
+ * against normal_distribution
+ */
+void noiseBench(Benchmark &bench);
+
+/**
+ * Verify the fast approximations and the numerical integrators of the kinematic model against the
+ * arc computed with the math library, report the accuracy of the integrators at coarse delta times,
+ * and benchmark the steps of all of them
+ */
+void vehicleBench(Benchmark &bench);
+
+/**
+ * Benchmark the car model moves and runs in both modes, and a full twiddle convergence. Verify
+ * the runs on dual numbers against the runs and their central differences, and benchmark them, and
+ * a noisy twiddle convergence against a coarse one refined with L-BFGS
+ */
+void twiddleBench(Benchmark &bench);
+
+/**
+ * Verify that telemetry frames are read back, and benchmark reading them and writing the response
+ */
+void messageBench(Benchmark &bench);
+
+#endif
@@ -0,0 +1,19 @@
+#include "benches.h"
+#include "../control/GainSchedule.h"
+
+void gainScheduleBench(Benchmark &bench) {
+  GainSchedule schedule(50, 10, 6);
+  for (int i = 0; i < schedule.size(); i++) {
+    double steering[3] = {0.1 + 0.01 * i, 3 + 0.1 * i, 0};
+    double throttle[3] = {13.5 - i, -11.4 + i, 0};
+    schedule.set(i, steering, throttle);
+  }
+  double speed = 0;
+  bench.run("GainSchedule::lookup", 1000000, [&]() {
+    double steering[3], throttle[3];
+    speed = speed < 120? speed + 0.37: 0;
+    schedule.lookup(speed, steering, throttle);
+    doNotOptimize(steering);
+    doNotOptimize(throttle);
+  });
+}
@@ -0,0 +1,66 @@
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../control/Messages.h"
+
+void messageBench(Benchmark &bench) {
+  // frames shaped like the telemetry of the simulator, with the base64 camera image it sends
+  const int N = 64;
+  default_random_engine generator(17);
+  normal_distribution<double> cte(0, 0.5);
+  uniform_real_distribution<double> speed(0, 60), angle(-25, 25);
+  uniform_int_distribution<int> letter(0, 63);
+  const string base64 = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+  vector<string> frames(N);
+  vector<Telemetry> expected(N);
+  for (int i = 0; i < N; i++) {
+    expected[i].cte = cte(generator);
+    expected[i].speed = speed(generator);
+    expected[i].angle = angle(generator);
+    string image(16 * 1024, 'A');
+    for (size_t k = 0; k < image.size(); k++) {
+      image[k] = base64[letter(generator)];
+    }
+    json data;
+    data["cte"] = to_string(expected[i].cte);
+    data["speed"] = to_string(expected[i].speed);
+    data["steering_angle"] = to_string(expected[i].angle);
+    data["throttle"] = "0.3000";
+    data["image"] = image;
+    frames[i] = "42[\"telemetry\"," + data.dump() + "]";
+  }
+
+  // make sure the frames are read back before timing them
+  for (int i = 0; i < N; i++) {
+    Telemetry t;
+    if (!parseTelemetry(json::parse(hasData(frames[i])), t) || t.cte != stod(to_string(expected[i].cte)) ||
+        t.speed != stod(to_string(expected[i].speed)) || t.angle != stod(to_string(expected[i].angle))) {
+      cerr << "Telemetry mismatch at frame " << i << endl;
+      exit(-1);
+    }
+  }
+
+  int i = 0;
+  bench.run("hasData", 20000, [&]() {
+    doNotOptimize(hasData(frames[i]).size());
+    i = (i + 1) % N;
+  });
+  vector<string> data(N);
+  for (int k = 0; k < N; k++) {
+    data[k] = hasData(frames[k]);
+  }
+  bench.run("json::parse", 2000, [&]() {
+    doNotOptimize(json::parse(data[i]).size());
+    i = (i + 1) % N;
+  });
+  bench.run("steerMessage", 100000, [&]() {
+    doNotOptimize(steerMessage(expected[i].angle / 25, 0.3).size());
+    i = (i + 1) % N;
+  });
+  bench.run("hasData+parseTelemetry+steerMessage", 2000, [&]() {
+    Telemetry t;
+    parseTelemetry(json::parse(hasData(frames[i])), t);
+    doNotOptimize(steerMessage(t.angle / 25, 0.3).size());
+    i = (i + 1) % N;
+  });
+}
@@ -0,0 +1,60 @@
+#include <math.h>
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../sim/Vehicle.h"
+#include "../utils/NormalGenerator.h"
+
+void noiseBench(Benchmark &bench) {
+  // make sure the generator draws standard normal variates before timing it
+  const int N = 1 << 20;
+  vector<double> variates(N);
+  NormalGenerator filled(3);
+  filled.fill(variates.data(), N);
+  NormalGenerator single(3);
+  double sum = 0, sum2 = 0, sum4 = 0;
+  for (int i = 0; i < N; i++) {
+    if (single() != variates[i]) {
+      cerr << "NormalGenerator fill mismatch at variate " << i << endl;
+      exit(-1);
+    }
+    double z = variates[i];
+    sum += z;
+    sum2 += z * z;
+    sum4 += z * z * z * z;
+  }
+  double mean = sum / N, variance = sum2 / N - mean * mean, kurtosis = sum4 / N / (variance * variance);
+  if (fabs(mean) > 0.01 || fabs(variance - 1) > 0.01 || fabs(kurtosis - 3) > 0.05) {
+    cerr << "NormalGenerator moments: mean " << mean << ", variance " << variance << ", kurtosis " << kurtosis << endl;
+    exit(-1);
+  }
+
+  default_random_engine generator(3);
+  normal_distribution<double> normal(0, 1);
+  bench.run("normal_distribution", 1000000, [&]() {
+    doNotOptimize(normal(generator));
+  });
+  NormalGenerator noise(3);
+  bench.run("NormalGenerator", 1000000, [&]() {
+    doNotOptimize(noise());
+  });
+  bench.run("NormalGenerator::fill/n256", 10000, [&]() {
+    noise.fill(variates.data(), 256);
+    doNotOptimize(variates[255]);
+  }, 256);
+
+  // a noisy step of the car model, with the noise drawn as CarTwiddle::move draws it
+  const double sigma[2] = {0.3, 0.01};
+  Vehicle car(2.5, 0, 0, 0, 20);
+  normal_distribution<double> rand_a(0, sigma[0]);
+  normal_distribution<double> rand_yawd(0, sigma[1]);
+  bench.run("Vehicle::move+normal_distribution", 1000000, [&]() {
+    car.move(0.05, 0.01 + rand_yawd(generator), rand_a(generator));
+    doNotOptimize(car.getX());
+  });
+  car = Vehicle(2.5, 0, 0, 0, 20);
+  bench.run("Vehicle::move+NormalGenerator", 1000000, [&]() {
+    car.move(0.05, 0.01 + noise(sigma[1]), noise(sigma[0]));
+    doNotOptimize(car.getX());
+  });
+}
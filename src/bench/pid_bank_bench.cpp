@@ -0,0 +1,72 @@
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../control/PID.h"
+#include "../control/PIDBank.h"
+#include "../control/PIDController.h"
+
+void pidBankBench(Benchmark &bench) {
+  default_random_engine generator(7);
+  uniform_real_distribution<double> coeff(0, 5);
+  normal_distribution<double> cte(0, 1);
+
+  const size_t sizes[] = {1, 16, 256, 4096};
+  for (int s = 0; s < 4; s++) {
+    size_t n = sizes[s];
+    string suffix = "/n" + to_string(n);
+    vector<PID> pids(n);
+    vector<PIDController<double> > controllers(n);
+    PIDBank bank(n);
+    for (size_t k = 0; k < n; k++) {
+      double Kp = coeff(generator), Kd = coeff(generator), Ki = coeff(generator) / 100;
+      pids[k].init(Kp, Kd, Ki);
+      controllers[k].init(Kp, Kd, Ki);
+      bank.init(k, Kp, Kd, Ki);
+    }
+    // a block of errors to feed the controllers
+    const size_t STEPS = 64;
+    vector<double> values(STEPS * n);
+    for (size_t i = 0; i < values.size(); i++) {
+      values[i] = cte(generator);
+    }
+    vector<double> controls(n);
+
+    // make sure the bank produces the same numbers as the scalar controllers before timing it
+    for (size_t step = 0; step < STEPS; step++) {
+      const double *v = &values[step * n];
+      bank.update(v, controls.data());
+      for (size_t k = 0; k < n; k++) {
+        pids[k].updateError(v[k]);
+        if (pids[k].getControl() != controls[k] || controllers[k].update(v[k]) != controls[k]) {
+          cerr << "PIDBank mismatch" << suffix << " at step " << step << ", controller " << k << endl;
+          exit(-1);
+        }
+      }
+    }
+
+    size_t step = 0;
+    bench.run("PID::updateError+getControl" + suffix, 1000000 / n + 1, [&]() {
+      const double *v = &values[(step++ % STEPS) * n];
+      for (size_t k = 0; k < n; k++) {
+        pids[k].updateError(v[k]);
+        controls[k] = pids[k].getControl();
+      }
+      doNotOptimize(controls[0]);
+    }, n);
+
+    step = 0;
+    bench.run("PIDController::update" + suffix, 1000000 / n + 1, [&]() {
+      const double *v = &values[(step++ % STEPS) * n];
+      for (size_t k = 0; k < n; k++) {
+        controls[k] = controllers[k].update(v[k]);
+      }
+      doNotOptimize(controls[0]);
+    }, n);
+
+    step = 0;
+    bench.run("PIDBank::update" + suffix, 1000000 / n + 1, [&]() {
+      bank.update(&values[(step++ % STEPS) * n], controls.data());
+      doNotOptimize(controls[0]);
+    }, n);
+  }
+}
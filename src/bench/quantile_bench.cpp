@@ -0,0 +1,90 @@
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../utils/Reducer.h"
+#include "../utils/QuantileReducer.h"
+
+/**
+ * Sort based baseline: copy the window out of the Reducer, sort it, and pick the quantile
+ */
+static double sortedQuantile(Reducer<double> &reducer, vector<double> &buffer, double q) {
+  buffer.resize(reducer.size());
+  for (int i = 0; i < reducer.size(); i++) {
+    buffer[i] = reducer[i];
+  }
+  sort(buffer.begin(), buffer.end());
+  return buffer[size_t(q * (buffer.size() - 1))];
+}
+
+/**
+ * Selection based baseline: copy the window out of the Reducer, and partially sort it with nth_element
+ */
+static double selectedQuantile(Reducer<double> &reducer, vector<double> &buffer, double q) {
+  buffer.resize(reducer.size());
+  for (int i = 0; i < reducer.size(); i++) {
+    buffer[i] = reducer[i];
+  }
+  vector<double>::iterator nth = buffer.begin() + size_t(q * (buffer.size() - 1));
+  nth_element(buffer.begin(), nth, buffer.end());
+  return *nth;
+}
+
+void quantileBench(Benchmark &bench) {
+  // CTE like samples with occasional spikes
+  const size_t N = 1 << 14;
+  vector<double> samples(N);
+  default_random_engine generator(42);
+  normal_distribution<double> cte(0, 0.5);
+  uniform_real_distribution<double> spike(0, 1);
+  for (size_t i = 0; i < N; i++) {
+    samples[i] = cte(generator) + (spike(generator) < 0.01? 5: 0);
+  }
+
+  const size_t windows[] = {5, 30, 200, 1000};
+  const double quantiles[] = {0.5, 0.95};
+  for (int w = 0; w < 4; w++) {
+    for (int k = 0; k < 2; k++) {
+      size_t window = windows[w];
+      double q = quantiles[k];
+      string suffix = "/q" + to_string(int(q * 100)) + "/w" + to_string(window);
+
+      // make sure the incremental quantile agrees with the baseline before timing it
+      {
+        QuantileReducer<double> quantile(window, q);
+        Reducer<double> reducer(window);
+        vector<double> buffer;
+        for (size_t i = 0; i < 4 * window; i++) {
+          quantile.push(samples[i % N]);
+          reducer.push(samples[i % N]);
+          if (quantile.quantile() != sortedQuantile(reducer, buffer, q)) {
+            cerr << "Quantile mismatch" << suffix << " at sample " << i << endl;
+            exit(-1);
+          }
+        }
+      }
+
+      QuantileReducer<double> quantile(window, q);
+      size_t i = 0;
+      bench.run("QuantileReducer::push+quantile" + suffix, 100000, [&]() {
+        quantile.push(samples[i++ & (N - 1)]);
+        doNotOptimize(quantile.quantile());
+      });
+
+      Reducer<double> sorted(window);
+      vector<double> buffer;
+      i = 0;
+      bench.run("Reducer::push+sort" + suffix, window >= 200? 5000: 100000, [&]() {
+        sorted.push(samples[i++ & (N - 1)]);
+        doNotOptimize(sortedQuantile(sorted, buffer, q));
+      });
+
+      Reducer<double> selected(window);
+      i = 0;
+      bench.run("Reducer::push+nth_element" + suffix, window >= 200? 5000: 100000, [&]() {
+        selected.push(samples[i++ & (N - 1)]);
+        doNotOptimize(selectedQuantile(selected, buffer, q));
+      });
+    }
+  }
+}
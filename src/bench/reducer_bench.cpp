@@ -0,0 +1,58 @@
+#include <algorithm>
+#include <cstdlib>
+#include <numeric>
+#include <random>
+#include "benches.h"
+#include "../utils/Reducer.h"
+
+void reducerBench(Benchmark &bench) {
+  const size_t N = 1 << 12;
+  vector<double> samples(N);
+  default_random_engine generator(13);
+  normal_distribution<double> cte(0, 0.5);
+  for (size_t i = 0; i < N; i++) {
+    samples[i] = cte(generator);
+  }
+
+  const int windows[] = {5, 30, 200, 1000};
+  for (int w = 0; w < 4; w++) {
+    int window = windows[w];
+    string suffix = "/w" + to_string(window);
+    Reducer<double> reducer(window);
+    vector<double> weights(window, 1);
+    for (int i = 0; i < window; i++) {
+      reducer.push(samples[i]);
+      weights[i] = i + 1;
+    }
+
+    // make sure the reductions agree with the standard algorithms before timing them
+    vector<double> window_samples(samples.begin(), samples.begin() + window);
+    if (reducer.max() != *max_element(window_samples.begin(), window_samples.end()) ||
+        reducer.min() != *min_element(window_samples.begin(), window_samples.end()) ||
+        reducer.sum() != accumulate(window_samples.begin(), window_samples.end(), 0.0)) {
+      cerr << "Reducer mismatch" << suffix << endl;
+      exit(-1);
+    }
+
+    size_t i = window;
+    bench.run("Reducer::push" + suffix, 1000000, [&]() {
+      reducer.push(samples[i++ & (N - 1)]);
+    });
+    long long iterations = 10000000 / window + 1;
+    bench.run("Reducer::max" + suffix, iterations, [&]() {
+      doNotOptimize(reducer.max());
+    }, window);
+    bench.run("Reducer::min" + suffix, iterations, [&]() {
+      doNotOptimize(reducer.min());
+    }, window);
+    bench.run("Reducer::sum" + suffix, iterations, [&]() {
+      doNotOptimize(reducer.sum());
+    }, window);
+    bench.run("Reducer::mean" + suffix, iterations, [&]() {
+      doNotOptimize(reducer.mean<double>());
+    }, window);
+    bench.run("Reducer::mean+weights" + suffix, iterations, [&]() {
+      doNotOptimize(reducer.mean<double>(weights.data()));
+    }, window);
+  }
+}
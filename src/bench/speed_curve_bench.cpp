@@ -0,0 +1,93 @@
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../control/SpeedCurve.h"
+
+enum Variant {PLAIN, MOVING_AVERAGE, STABILIZED};
+
+/**
+ * The if chain computeSpeedTarget() of pid_main which SpeedCurve replaces, the variants were selected
+ * with the STABILIZE_MOTION and USE_MOVING_AVERAGE macros
+ */
+static double legacySpeedTarget(double angle, double max, Variant variant) {
+  double y = fabs(angle);
+  if (y < 0.02) return max;
+  if (y < 0.075 ) return std::fmin(max,95);
+  if (variant == STABILIZED) {
+    if (y < 0.1 ) return std::fmin(max, 90);
+    if (y < 0.12 ) return std::fmin(max, 85);
+    if (y < 0.125 ) return std::fmin(max, 40);
+  } else if (variant == MOVING_AVERAGE) {
+    if (y < 0.0875 ) return std::fmin(max, 90);
+    if (y < 0.12 ) return std::fmin(max, 55);
+    if (y < 0.13 ) return std::fmin(max, 40);
+    if (y < 0.14) return std::fmin(max, 35);
+  } else {
+    if (y < 0.0875 ) return std::fmin(max, 90);
+    if (y < 0.12 ) return std::fmin(max, 85);
+    if (y < 0.13 ) return std::fmin(max, 60);
+    if (y < 0.14) return std::fmin(max, 35);
+  }
+  if (y < 0.3 ) return std::fmin(max, 30);
+  if (y < 0.5 ) return std::fmin(max, 25);
+  return std::fmin(max, 20);
+}
+
+/**
+ * Make sure the curve gives identical output to the if chain, on a dense sweep of angles, and
+ * around every threshold
+ */
+static void verify(const SpeedCurve &curve, Variant variant, const char *name) {
+  static const double thresholds[] = {0.02, 0.075, 0.0875, 0.1, 0.12, 0.125, 0.13, 0.14, 0.3, 0.5};
+  static const double maxes[] = {100, 92.5, 50, 10};
+  vector<double> angles;
+  for (int i = -20000; i <= 20000; i++) {
+    angles.push_back(i * 0.00005);
+  }
+  for (int i = 0; i < 10; i++) {
+    double t = thresholds[i];
+    angles.push_back(t);
+    angles.push_back(-t);
+    angles.push_back(nextafter(t, 0));
+    angles.push_back(nextafter(t, 1));
+  }
+  angles.push_back(0);
+  angles.push_back(INFINITY);
+  angles.push_back(NAN);
+  for (size_t i = 0; i < angles.size(); i++) {
+    for (int k = 0; k < 4; k++) {
+      double expected = legacySpeedTarget(angles[i], maxes[k], variant);
+      double actual = curve.lookup(angles[i], maxes[k]);
+      if (expected != actual) {
+        cerr << "SpeedCurve " << name << " mismatch at angle " << angles[i] << ": " << actual
+             << ", expected " << expected << endl;
+        exit(-1);
+      }
+    }
+  }
+}
+
+void speedCurveBench(Benchmark &bench) {
+  verify(SpeedCurve::plain(), PLAIN, "plain");
+  verify(SpeedCurve::movingAverage(), MOVING_AVERAGE, "moving average");
+  verify(SpeedCurve::stabilized(), STABILIZED, "stabilized");
+
+  // angles of a drive, mostly small with some turns
+  const size_t N = 1 << 12;
+  vector<double> angles(N);
+  default_random_engine generator(3);
+  normal_distribution<double> angle(0, 0.1);
+  for (size_t i = 0; i < N; i++) {
+    angles[i] = angle(generator);
+  }
+
+  size_t i = 0;
+  bench.run("computeSpeedTarget", 1000000, [&]() {
+    doNotOptimize(legacySpeedTarget(angles[i++ & (N - 1)], 100, PLAIN));
+  });
+  SpeedCurve curve = SpeedCurve::plain();
+  i = 0;
+  bench.run("SpeedCurve::lookup", 1000000, [&]() {
+    doNotOptimize(curve.lookup(angles[i++ & (N - 1)], 100));
+  });
+}
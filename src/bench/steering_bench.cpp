@@ -0,0 +1,79 @@
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../control/DriveSettings.h"
+#include "../control/SteeringPipeline.h"
+#include "../sim/ClosedLoop.h"
+
+/**
+ * Benchmark a combination of the steering stages
+ */
+template<class Steering> static void benchSteering(Benchmark &bench, const string &name,
+                                                   const vector<double> &inputs) {
+  Steering steering;
+  size_t n = inputs.size() / 3;
+  size_t i = 0;
+  bench.run("SteeringPipeline::process/" + name, 1000000, [&]() {
+    const double *input = &inputs[(i++ % n) * 3];
+    doNotOptimize(steering.process(input[0], input[1], input[2]));
+  });
+}
+
+/**
+ * Verify that the default coefficients and speed curve of a combination of the steering stages
+ * drive noisy laps of the oval track without leaving it, and benchmark a lap
+ */
+static void benchLaps(Benchmark &bench, const string &stages, bool stabilize, bool moving_average, bool clamp_delta, bool mean_turn) {
+  DriveSettings settings;
+  settings.stabilize = stabilize;
+  settings.moving_average = moving_average;
+  settings.clamp_delta = clamp_delta;
+  settings.mean_turn = mean_turn;
+  settings.finish();
+  Track track = Track::oval(300, 80, 1);
+  LapOptions options;
+  options.noise[0] = 1;
+  options.noise[1] = 0.01;
+  settings.withSteering([&](auto steering) {
+    ClosedLoop<decltype(steering)> loop(settings, track, options);
+    string name = "ClosedLoop::run/" + stages;
+    const unsigned LAPS = 8;
+    for (unsigned seed = 0; seed < LAPS; seed++) {
+      LapResult result = loop.run(seed);
+      if (!result.completed) {
+        cerr << name << " did not complete lap " << seed << ", max CTE " << result.max_cte << endl;
+        exit(-1);
+      }
+    }
+    unsigned seed = 0;
+    bench.run(name, 4, [&]() {
+      doNotOptimize(loop.run(seed++).time);
+    });
+  });
+}
+
+void steeringBench(Benchmark &bench) {
+  // steering values, speeds, and steering angles
+  const size_t N = 4096;
+  vector<double> inputs(N * 3);
+  default_random_engine generator(11);
+  normal_distribution<double> noise(0, 1);
+  for (size_t i = 0; i < N; i++) {
+    inputs[i * 3] = 0.3 * noise(generator);
+    inputs[i * 3 + 1] = 50 + 10 * noise(generator);
+    inputs[i * 3 + 2] = 5 * noise(generator);
+  }
+  benchSteering<SteeringPipeline<false, false, false, false> >(bench, "plain", inputs);
+  benchSteering<SteeringPipeline<false, true, false, false> >(bench, "moving_average", inputs);
+  benchSteering<SteeringPipeline<true, true, false, false> >(bench, "stabilize", inputs);
+  benchSteering<SteeringPipeline<true, true, true, false> >(bench, "stabilize+clamp_delta", inputs);
+  benchSteering<SteeringPipeline<true, true, false, true> >(bench, "stabilize+mean_turn", inputs);
+  benchSteering<SteeringPipeline<true, true, true, true> >(bench, "stabilize+clamp_delta+mean_turn", inputs);
+
+  benchLaps(bench, "plain", false, false, false, false);
+  benchLaps(bench, "moving_average", false, true, false, false);
+  benchLaps(bench, "stabilize", true, true, false, false);
+  benchLaps(bench, "stabilize+clamp_delta", true, true, true, false);
+  benchLaps(bench, "stabilize+mean_turn", true, true, false, true);
+  benchLaps(bench, "stabilize+clamp_delta+mean_turn", true, true, true, true);
+}
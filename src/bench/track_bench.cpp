@@ -0,0 +1,55 @@
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../sim/Track.h"
+
+void trackBench(Benchmark &bench) {
+  // the same oval sampled with 100 to 100,000 points
+  const int sizes[] = {100, 10000, 100000};
+  for (int s = 0; s < 3; s++) {
+    Track track = Track::oval(300, 80, (600 + 2 * M_PI * 80) / sizes[s]);
+    string suffix = "/n" + to_string(track.size());
+
+    // points around the track, in the order a car drives by them
+    const int N = 4096;
+    default_random_engine generator(5);
+    normal_distribution<double> offset(0, 2);
+    vector<double> xs(N), ys(N);
+    for (int i = 0; i < N; i++) {
+      int p = (int)((long long)i * track.size() / N);
+      double heading = track.getHeading(p), o = offset(generator);
+      xs[i] = track.getX(p) - o * sin(heading);
+      ys[i] = track.getY(p) + o * cos(heading);
+    }
+
+    // make sure the hierarchy finds the same segments as comparing all of them before timing it
+    int hint = -1;
+    for (int i = 0; i < N; i++) {
+      TrackPosition expected = track.locateLinear(xs[i], ys[i]);
+      TrackPosition found = track.locate(xs[i], ys[i]);
+      TrackPosition hinted = track.locate(xs[i], ys[i], hint);
+      if (found.segment != expected.segment || found.cte != expected.cte ||
+          hinted.segment != expected.segment || hinted.cte != expected.cte) {
+        cerr << "Track mismatch" << suffix << " at point " << i << endl;
+        exit(-1);
+      }
+    }
+
+    int i = 0;
+    if (track.size() <= 10000) {
+      bench.run("Track::locateLinear" + suffix, 100000000 / track.size() / 10 + 1, [&]() {
+        doNotOptimize(track.locateLinear(xs[i], ys[i]).cte);
+        i = (i + 1) % N;
+      });
+    }
+    bench.run("Track::locate" + suffix, 200000, [&]() {
+      doNotOptimize(track.locate(xs[i], ys[i]).cte);
+      i = (i + 1) % N;
+    });
+    hint = -1;
+    bench.run("Track::locate+hint" + suffix, 200000, [&]() {
+      doNotOptimize(track.locate(xs[i], ys[i], hint).cte);
+      i = (i + 1) % N;
+    });
+  }
+}
@@ -0,0 +1,228 @@
+#include <stdio.h>
+#include <unistd.h>
+#include <cstdlib>
+#include <cstring>
+#include "benches.h"
+#include "../sim/FileTrajectorySink.h"
+#include "../sim/MemoryTrajectorySink.h"
+#include "../tune/BayesTuner.h"
+#include "../tune/CarTwiddle.h"
+#include "../tune/ParallelTwiddle.h"
+#include "../tune/LBFGS.h"
+#include "../utils/MappedLog.h"
+#include "../utils/ThreadPool.h"
+
+void twiddleBench(Benchmark &bench) {
+  double noise[2] = {0, 0};
+  CarTwiddle car(2.5, 0, 1, 0, 30, noise);
+  double steering = 0;
+  bench.run("CarTwiddle::move", 1000000, [&]() {
+    steering = steering < 0.4? steering + 0.01: -0.4;
+    car.move(0.05, steering, 0);
+  });
+
+  VectorXd p(3);
+  p << 0.5, 2.5, 0.001;
+  for (int mode = 1; mode <= 2; mode++) {
+    string suffix = mode == car.STEERING_MODE? "/steering": "/acceleration";
+    double target = mode == car.STEERING_MODE? 0: 35;
+    car.setMode(mode);
+    bench.run("CarTwiddle::run/steps200" + suffix, 2000, [&]() {
+      doNotOptimize(car.run(p, target, 100, 0.1, NULL));
+    }, 200);
+  }
+
+  // noisy runs drawing new noise in every step from the normal distributions and from the batched
+  // generator, whose replayed noise must be the noise a run draws right after seeding
+  double step_noise[2] = {0.1, 0.01};
+  for (int batched = 0; batched <= 1; batched++) {
+    string suffix = batched? "/NormalGenerator": "/normal_distribution";
+    CarTwiddle drawing(2.5, 0, 1, 0, 22.36, step_noise);
+    drawing.setBatchedNoise(batched);
+    drawing.setSeed(7);
+    CarTwiddle replaying(drawing);
+    replaying.setSeed(7);
+    replaying.setCommonNoise(true);
+    double error = drawing.run(p, 0, 100, 0.1, NULL);
+    if (error != replaying.run(p, 0, 100, 0.1, NULL) || error == drawing.run(p, 0, 100, 0.1, NULL)) {
+      cerr << "The replayed noise" << suffix << " is not the noise of a run" << endl;
+      exit(-1);
+    }
+    bench.run("CarTwiddle::run/noisy" + suffix, 2000, [&]() {
+      doNotOptimize(drawing.run(p, 0, 100, 0.1, NULL));
+    }, 200);
+  }
+
+  // long runs recording their trajectories, which must be the same in memory and in the file, to a
+  // temporary file that is removed once they are timed
+  car.setMode(car.STEERING_MODE);
+  const int steps = 500000;
+  if (bench.isEnabled("CarTwiddle::run/steps1M") || bench.isEnabled("CarTwiddle::run/steps1M/memory") ||
+      bench.isEnabled("CarTwiddle::run/steps1M/file")) {
+    char name[] = "/tmp/pid_bench_trajectory.XXXXXX";
+    int fd = mkstemp(name);
+    if (fd < 0) {
+      cerr << "Failed to create a temporary file: " << name << endl;
+      exit(-1);
+    }
+    close(fd);
+    const string path = name;
+    MemoryTrajectorySink memory;
+    FileTrajectorySink file;
+    double error = car.run(p, 0, steps, 0.01, &memory);
+    if (!file.open(path) || car.run(p, 0, steps, 0.01, &file) != error || !file.close()) {
+      cerr << "Failed to record the trajectory: " << path << endl;
+      unlink(path.c_str());
+      exit(-1);
+    }
+    MappedLog<TrajectoryPoint> log;
+    if (memory.getPoints().size() != 2 * steps || !log.open(path) || log.size() != 2 * steps ||
+        memcmp(log.data(), memory.getPoints().data(), log.size() * sizeof(TrajectoryPoint)) != 0) {
+      cerr << "Recorded trajectories differ" << endl;
+      unlink(path.c_str());
+      exit(-1);
+    }
+    log.close();
+    bench.run("CarTwiddle::run/steps1M", 3, [&]() {
+      doNotOptimize(car.run(p, 0, steps, 0.01, NULL));
+    }, 2 * steps);
+    bench.run("CarTwiddle::run/steps1M/memory", 3, [&]() {
+      memory.clear();
+      doNotOptimize(car.run(p, 0, steps, 0.01, &memory));
+    }, 2 * steps);
+    bench.run("CarTwiddle::run/steps1M/file", 3, [&]() {
+      file.open(path);
+      doNotOptimize(car.run(p, 0, steps, 0.01, &file));
+      file.close();
+    }, 2 * steps);
+    unlink(path.c_str());
+  }
+
+  // a full convergence of the steering coefficients, which must converge to the same coefficients
+  // every time for the timing to be comparable
+  car.setMode(car.STEERING_MODE);
+  VectorXd expected(3);
+  car.twiddle(expected, 0, 100, 0.1, 0.0001);
+  bench.run("Twiddle::twiddle/steering", 3, [&]() {
+    car.twiddle(p, 0, 100, 0.1, 0.0001);
+    if (p != expected) {
+      cerr << "Twiddle converged to different coefficients" << endl;
+      exit(-1);
+    }
+  });
+
+  // the runs on dual numbers must have the errors of the runs, and the gradients of their central
+  // differences, with noise replayed in every run
+  double noises[2] = {0.1, 0.01};
+  CarTwiddle noisy(2.5, 0, 1, 0, 22.36, noises);
+  noisy.setCommonNoise(true);
+  for (int mode = 1; mode <= 2; mode++) {
+    string suffix = mode == noisy.STEERING_MODE? "/steering": "/acceleration";
+    double target = mode == noisy.STEERING_MODE? 0: 25;
+    noisy.setMode(mode);
+    VectorXd gradient;
+    double error = noisy.runGradient(p, target, 100, 0.1, gradient);
+    if (error != noisy.run(p, target, 100, 0.1, NULL)) {
+      cerr << "Gradient run error mismatch in mode " << mode << endl;
+      exit(-1);
+    }
+    for (int k = 0; k < 3; k++) {
+      double h = 1e-6 * fmax(1, fabs(p[k]));
+      VectorXd a = p, b = p;
+      a[k] += h;
+      b[k] -= h;
+      double difference = (noisy.run(a, target, 100, 0.1, NULL) - noisy.run(b, target, 100, 0.1, NULL)) / (2 * h);
+      if (fabs(gradient[k] - difference) > 1e-4 * fmax(fabs(difference), 1e-3)) {
+        cerr << "Gradient mismatch in mode " << mode << ", coefficient " << k << ": " << gradient[k] << " "
+             << difference << endl;
+        exit(-1);
+      }
+    }
+    bench.run("CarTwiddle::runGradient/steps200" + suffix, 2000, [&]() {
+      doNotOptimize(noisy.runGradient(p, target, 100, 0.1, gradient));
+    }, 200);
+  }
+
+  // a full convergence of the noisy steering coefficients, and a coarse one refined with L-BFGS,
+  // which must reach the same error
+  noisy.setMode(noisy.STEERING_MODE);
+  double twiddled = noisy.twiddle(expected, 0, 200, 0.05, 0.0001);
+  LBFGS lbfgs;
+  LBFGS::Function f = [&](const VectorXd &x, VectorXd &gradient) {
+    return noisy.runGradient(x, 0, 200, 0.05, gradient);
+  };
+  noisy.twiddle(p, 0, 200, 0.05, 0.1);
+  if (lbfgs.minimize(f, p) > twiddled * (1 + 1e-3)) {
+    cerr << "L-BFGS converged to a larger error than twiddle" << endl;
+    exit(-1);
+  }
+  bench.run("Twiddle::twiddle/noisy", 3, [&]() {
+    doNotOptimize(noisy.twiddle(p, 0, 200, 0.05, 0.0001));
+  });
+  bench.run("LBFGS::minimize/noisy", 3, [&]() {
+    noisy.twiddle(p, 0, 200, 0.05, 0.1);
+    doNotOptimize(lbfgs.minimize(f, p));
+  });
+
+  // Bayesian optimization of the noisy steering coefficients in a tenth of the runs of twiddle,
+  // which must come within a few percent of its error, and tune the same coefficients every time
+  VectorXd upper(3);
+  upper << 2, 5, 0.05;
+  BayesTuner tuner(-upper, upper, 4, 1);
+  double optimized = tuner.tune(noisy, expected, 0, 200, 0.05, 100);
+  if (optimized > twiddled * 1.05) {
+    cerr << "Bayesian optimization converged to a larger error than twiddle: " << optimized << " " << twiddled
+         << endl;
+    exit(-1);
+  }
+  bench.run("BayesTuner::tune/noisy", 3, [&]() {
+    BayesTuner tuner(-upper, upper, 4, 1);
+    tuner.tune(noisy, p, 0, 200, 0.05, 100);
+    if (p != expected) {
+      cerr << "Bayesian optimization converged to different coefficients" << endl;
+      exit(-1);
+    }
+  });
+
+  // the joint runs on dual numbers must have the gradients of their central differences too
+  VectorXd joint_p(6);
+  joint_p << 0.5, 2.5, 0.001, 1, 0.5, 0.001;
+  noisy.setMode(noisy.JOINT_MODE);
+  VectorXd joint_gradient;
+  if (noisy.runGradient(joint_p, 25, 100, 0.1, joint_gradient) != noisy.run(joint_p, 25, 100, 0.1, NULL)) {
+    cerr << "Gradient run error mismatch in joint mode" << endl;
+    exit(-1);
+  }
+  for (int k = 0; k < 6; k++) {
+    double h = 1e-6 * fmax(1, fabs(joint_p[k]));
+    VectorXd a = joint_p, b = joint_p;
+    a[k] += h;
+    b[k] -= h;
+    double difference = (noisy.run(a, 25, 100, 0.1, NULL) - noisy.run(b, 25, 100, 0.1, NULL)) / (2 * h);
+    if (fabs(joint_gradient[k] - difference) > 1e-4 * fmax(fabs(difference), 1e-3)) {
+      cerr << "Gradient mismatch in joint mode, coefficient " << k << ": " << joint_gradient[k] << " " << difference
+           << endl;
+      exit(-1);
+    }
+  }
+
+  // the joint twiddle in batches of the runs of every state it may be in, which must tune the
+  // coefficients of the twiddle one run after another
+  VectorXd joint_expected(6);
+  noisy.twiddle(joint_expected, 25, 200, 0.05, 0.0001);
+  bench.run("Twiddle::twiddle/joint", 3, [&]() {
+    doNotOptimize(noisy.twiddle(joint_p, 25, 200, 0.05, 0.0001));
+  });
+  ThreadPool pool;
+  for (int width: {2, 8, 26}) {
+    ParallelTwiddle parallel(noisy, pool);
+    parallel.twiddleBatch(joint_p, 25, 200, 0.05, 0.0001, width);
+    if (joint_p != joint_expected) {
+      cerr << "Batched twiddle of width " << width << " converged to different coefficients" << endl;
+      exit(-1);
+    }
+    bench.run("Twiddle::twiddleBatch/joint/width" + to_string(width), 3, [&]() {
+      doNotOptimize(parallel.twiddleBatch(joint_p, 25, 200, 0.05, 0.0001, width));
+    });
+  }
+}
@@ -0,0 +1,173 @@
+#include <math.h>
+#include <cstdlib>
+#include <random>
+#include "benches.h"
+#include "../sim/MemoryTrajectorySink.h"
+#include "../sim/Vehicle.h"
+#include "../tune/CarTwiddle.h"
+#include "../utils/FastMath.h"
+#include "../utils/MathUtils.h"
+
+void vehicleBench(Benchmark &bench) {
+  // make sure the approximations are within their bounds before timing them
+  double log_error = 0, sin_error = 0, tan_error = 0, wrap_error = 0;
+  for (int i = 1; i <= 1000000; i++) {
+    double x = i * 1e-6;
+    log_error = fmax(log_error, fabs(fastLog(x) - log(x)) / fmax(fabs(log(x)), 1e-3));
+    double a = (i - 500000) * 1e-5, s, c;
+    fastSinCos(a, s, c);
+    sin_error = fmax(sin_error, fmax(fabs(s - sin(a)), fabs(c - cos(a))));
+    // beyond the steering limits, and across pi / 4 where the tangent starts reducing the angle
+    double t = a * 0.3;
+    tan_error = fmax(tan_error, fabs(fastTan(t) - tan(t)) / fmax(fabs(tan(t)), 1e-3));
+    wrap_error = fmax(wrap_error, fabs(normalizeAngle(wrapAngle(a * 10) - normalizeAngle(a * 10))));
+  }
+  if (log_error > 2e-12 || sin_error > 2e-15 || tan_error > 2e-15 || wrap_error > 1e-12) {
+    cerr << "FastMath errors: log " << log_error << ", sincos " << sin_error << ", tan " << tan_error
+         << ", wrap " << wrap_error << endl;
+    exit(-1);
+  }
+
+  // random states and controls of a step, up to the limits of the car
+  const int N = 4096;
+  default_random_engine generator(11);
+  uniform_real_distribution<double> yaw(-M_PI, M_PI), velocity(0, 50), steering(-0.5, 0.5), accel(-20, 8);
+  vector<Vehicle> states(N);
+  vector<double> steerings(N), accels(N);
+  for (int i = 0; i < N; i++) {
+    states[i] = Vehicle(2.5, 0, 0, yaw(generator), velocity(generator));
+    steerings[i] = steering(generator);
+    accels[i] = accel(generator);
+  }
+  // the steps of the exact and fast models from the same states must agree
+  for (int i = 0; i < N; i++) {
+    Vehicle exact = states[i], fast = states[i];
+    fast.setFastMath(true);
+    for (int k = 0; k < 2; k++) {
+      // a straight step as well as a turn
+      double angle = k == 0? steerings[i]: 1e-9;
+      exact.move(0.1, angle, accels[i]);
+      fast.move(0.1, angle, accels[i]);
+      if (fabs(exact.getX() - fast.getX()) > 1e-9 || fabs(exact.getY() - fast.getY()) > 1e-9 ||
+          fabs(normalizeAngle(exact.getYaw() - fast.getYaw())) > 1e-12 || exact.getVelocity() != fast.getVelocity()) {
+        cerr << "Vehicle fast math mismatch at state " << i << ", step " << k << endl;
+        exit(-1);
+      }
+    }
+  }
+  // the same for whole runs, which feed the steps back through the PID
+  double noise[2] = {0, 0};
+  VectorXd p(3);
+  p << 0.5, 2.5, 0.001;
+  for (int mode = 1; mode <= 2; mode++) {
+    CarTwiddle car(2.5, 0, 1, 0, 30, noise), fast(2.5, 0, 1, 0, 30, noise);
+    car.setMode(mode);
+    fast.setMode(mode);
+    fast.setFastMath(true);
+    double target = mode == car.STEERING_MODE? 0: 35;
+    double error = car.run(p, target, 1000, 0.1, NULL);
+    double fast_error = fast.run(p, target, 1000, 0.1, NULL);
+    if (fabs(fast_error - error) > 1e-9 * fmax(error, 1)) {
+      cerr << "CarTwiddle fast math mismatch in mode " << mode << ": " << error << " " << fast_error << endl;
+      exit(-1);
+    }
+  }
+
+  // the steps of the numerical integrators from the same states must be close to the arc, which is
+  // exact below the maximal velocity
+  const char *integrators[3] = {"arc", "rk4", "adaptive"};
+  double step_errors[3] = {0, 0, 0};
+  for (int integrator = 1; integrator <= 2; integrator++) {
+    for (int i = 0; i < N; i++) {
+      Vehicle exact = states[i], numerical = states[i];
+      numerical.setIntegrator(integrator);
+      exact.move(0.1, steerings[i], accels[i]);
+      numerical.move(0.1, steerings[i], accels[i]);
+      double error = hypot(exact.getX() - numerical.getX(), exact.getY() - numerical.getY());
+      step_errors[integrator] = fmax(step_errors[integrator], error);
+    }
+  }
+  if (step_errors[1] > 1e-2 || step_errors[2] > 1e-8) {
+    cerr << "Integrator step errors: rk4 " << step_errors[1] << ", adaptive " << step_errors[2] << endl;
+    exit(-1);
+  }
+  // the adaptive steps keep to the tolerance, and move the whole step when it cannot be reached, with
+  // the substeps above it counted
+  long long forced = 0, unreachable = 0;
+  double unreachable_error = 0;
+  for (int i = 0; i < N; i++) {
+    Vehicle exact = states[i], numerical = states[i], limited = states[i];
+    numerical.setIntegrator(Vehicle::ADAPTIVE_INTEGRATOR);
+    limited.setIntegrator(Vehicle::ADAPTIVE_INTEGRATOR);
+    limited.setTolerance(0);
+    exact.move(0.1, steerings[i], accels[i]);
+    numerical.move(0.1, steerings[i], accels[i]);
+    limited.move(0.1, steerings[i], accels[i]);
+    forced += numerical.getForcedSubsteps();
+    unreachable += limited.getForcedSubsteps() > 0;
+    unreachable_error = fmax(unreachable_error, hypot(exact.getX() - limited.getX(), exact.getY() - limited.getY()));
+  }
+  if (forced > 0 || unreachable != N || unreachable_error > 1e-4) {
+    cerr << "Adaptive substeps: " << forced << " above the tolerance, " << unreachable << " of " << N
+         << " steps counted at a zero tolerance, with position error " << unreachable_error << endl;
+    exit(-1);
+  }
+  // the accuracy of the steering runs at coarse delta times, as the RMS of the distance of the car
+  // to the x axis from the one of a run at 0.01 at the same times
+  MemoryTrajectorySink reference;
+  CarTwiddle reference_car(2.5, 0, 1, 0, 20, noise);
+  reference_car.run(p, 0, 1000, 0.01, &reference);
+  cout << "Integrator accuracy, the most position error of a step of 0.1, and the RMS deviation of steering runs from dt 0.01:" << endl;
+  for (int integrator = 0; integrator <= 2; integrator++) {
+    cout << "  " << integrators[integrator] << ": step " << step_errors[integrator];
+    for (int n = 5; n <= 10; n += 5) {
+      MemoryTrajectorySink sink;
+      CarTwiddle car(2.5, 0, 1, 0, 20, noise);
+      car.setIntegrator(integrator);
+      car.run(p, 0, 1000 / n, 0.01 * n, &sink);
+      double deviation = 0;
+      for (size_t k = 0; k < sink.getPoints().size(); k++) {
+        double d = sink.getPoints()[k].y - reference.getPoints()[(k + 1) * n - 1].y;
+        deviation += d * d;
+      }
+      cout << ", dt " << 0.01 * n << " " << sqrt(deviation / sink.getPoints().size());
+    }
+    cout << endl;
+  }
+
+  for (int fast = 0; fast <= 1; fast++) {
+    string suffix = fast? "/fast": "/exact";
+    Vehicle car(2.5, 0, 0, 0, 20);
+    car.setFastMath(fast);
+    int i = 0;
+    bench.run("Vehicle::move" + suffix, 1000000, [&]() {
+      car.move(0.05, steerings[i], 0);
+      doNotOptimize(car.getX());
+      i = (i + 1) % N;
+    });
+    CarTwiddle twiddle(2.5, 0, 1, 0, 30, noise);
+    twiddle.setFastMath(fast);
+    // replay the noise, so that the steps are timed rather than drawing the noise
+    twiddle.setCommonNoise(true);
+    bench.run("CarTwiddle::run/steps200" + suffix, 2000, [&]() {
+      doNotOptimize(twiddle.run(p, 0, 100, 0.1, NULL));
+    }, 200);
+  }
+  for (int integrator = 1; integrator <= 2; integrator++) {
+    string suffix = string("/") + integrators[integrator];
+    Vehicle car(2.5, 0, 0, 0, 20);
+    car.setIntegrator(integrator);
+    int i = 0;
+    bench.run("Vehicle::move" + suffix, 1000000, [&]() {
+      car.move(0.05, steerings[i], 0);
+      doNotOptimize(car.getX());
+      i = (i + 1) % N;
+    });
+    CarTwiddle twiddle(2.5, 0, 1, 0, 30, noise);
+    twiddle.setIntegrator(integrator);
+    twiddle.setCommonNoise(true);
+    bench.run("CarTwiddle::run/steps200" + suffix, 2000, [&]() {
+      doNotOptimize(twiddle.run(p, 0, 100, 0.1, NULL));
+    }, 200);
+  }
+}
@@ -0,0 +1,140 @@
+#include <stdio.h>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include "bench/Benchmark.h"
+#include "bench/Comparison.h"
+
+void usage() {
+  std::cerr << "Usage: bench_compare baseline.json candidate.json [-threshold t] [-limit pattern t] "
+            << "[-alpha a] [-resamples n] [-seed s] [-allow_missing]" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+  std::string baseline_file = ""; // the results of the baseline, written by pid_bench -json
+  std::string candidate_file = ""; // the results of the candidate
+  double threshold = 0.05; // relative slow down above which a benchmark regressed
+  double alpha = 0.05; // significance level
+  int resamples = 2000; // number of bootstrap resamples
+  unsigned seed = 1; // seed of the bootstrap resamples
+  std::vector<std::pair<std::string, double> > limits; // thresholds of the benchmarks matching a pattern
+  bool allow_missing = false; // true not to fail for benchmarks missing from the candidate
+
+  // Process command line options
+  for (int i = 1; i < argc; i++) {
+    if (std::string((argv[i])) == "-threshold") { // threshold
+      if (i + 1 >= argc || sscanf(argv[++i], "%lf", &threshold) != 1 || threshold < 0) {
+        std::cerr << "Invalid threshold: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-limit") { // threshold of the benchmarks matching a pattern
+      double limit;
+      if (i + 2 >= argc || sscanf(argv[i + 2], "%lf", &limit) != 1 || limit < 0) {
+        std::cerr << "Invalid limit: " << argv[i] << std::endl;
+        exit(-1);
+      }
+      limits.push_back(std::make_pair(std::string(argv[i + 1]), limit));
+      i += 2;
+    } else if (std::string((argv[i])) == "-alpha") { // significance level
+      if (i + 1 >= argc || sscanf(argv[++i], "%lf", &alpha) != 1 || alpha <= 0 || alpha >= 1) {
+        std::cerr << "Invalid significance level: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-resamples") { // bootstrap resamples
+      if (i + 1 >= argc || sscanf(argv[++i], "%d", &resamples) != 1 || resamples <= 0) {
+        std::cerr << "Invalid resamples: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-seed") { // bootstrap seed
+      if (i + 1 >= argc || sscanf(argv[++i], "%u", &seed) != 1) {
+        std::cerr << "Invalid seed: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-allow_missing") { // benchmarks may be missing from the candidate
+      allow_missing = true;
+    } else if (argv[i][0] != '-' && baseline_file.empty()) {
+      baseline_file = argv[i];
+    } else if (argv[i][0] != '-' && candidate_file.empty()) {
+      candidate_file = argv[i];
+    } else {
+      std::cerr << "Unknown option: " << argv[i] << std::endl;
+      usage();
+      exit(-1);
+    }
+  }
+  if (candidate_file.empty()) {
+    usage();
+    exit(-1);
+  }
+
+  std::vector<Benchmark::Result> baseline, candidate;
+  if (!Benchmark::loadJson(baseline_file, baseline)) {
+    std::cerr << "Failed to load results: " << baseline_file << std::endl;
+    exit(-1);
+  }
+  if (!Benchmark::loadJson(candidate_file, candidate)) {
+    std::cerr << "Failed to load results: " << candidate_file << std::endl;
+    exit(-1);
+  }
+
+  Comparison comparison(alpha, threshold, resamples, 1 - alpha, seed);
+  for (size_t i = 0; i < limits.size(); i++) {
+    comparison.setThreshold(limits[i].first, limits[i].second);
+  }
+  std::map<std::string, const Benchmark::Result *> candidates;
+  for (size_t i = 0; i < candidate.size(); i++) {
+    candidates[candidate[i].name] = &candidate[i];
+  }
+
+  int regressions = 0, improvements = 0, undecided = 0, missing = 0;
+  std::cout << std::left << std::setw(44) << "benchmark" << std::right
+            << std::setw(12) << "base ns" << std::setw(12) << "cand ns" << std::setw(9) << "change"
+            << std::setw(20) << "interval" << std::setw(9) << "p" << std::setw(8) << "limit" << "  verdict" << std::endl;
+  std::cout << std::fixed;
+  for (size_t i = 0; i < baseline.size(); i++) {
+    std::map<std::string, const Benchmark::Result *>::iterator found = candidates.find(baseline[i].name);
+    if (found == candidates.end()) {
+      std::cout << std::left << std::setw(44) << baseline[i].name << std::right << "  MISSING from candidate" << std::endl;
+      missing++;
+      continue;
+    }
+    Comparison::Outcome outcome = comparison.compare(baseline[i], *found->second);
+    candidates.erase(found);
+    std::string verdict = "";
+    if (outcome.verdict == Comparison::REGRESSION) {
+      verdict = "REGRESSION";
+      regressions++;
+    } else if (outcome.verdict == Comparison::IMPROVEMENT) {
+      verdict = "improvement";
+      improvements++;
+    } else if (outcome.verdict == Comparison::UNDECIDED) {
+      verdict = "UNDECIDED";
+      undecided++;
+    }
+    std::ostringstream interval;
+    interval << std::fixed << std::setprecision(1) << std::showpos << "[" << 100 * outcome.low << "%, " << 100 * outcome.high << "%]";
+    std::cout << std::left << std::setw(44) << outcome.name << std::right << std::setprecision(1)
+              << std::setw(12) << outcome.baseline << std::setw(12) << outcome.candidate
+              << std::setw(8) << std::showpos << 100 * outcome.change << "%" << std::noshowpos
+              << std::setw(20) << interval.str() << std::setprecision(3) << std::setw(9) << outcome.p_value
+              << std::setprecision(1) << std::setw(7) << 100 * outcome.threshold << "%  " << verdict << std::endl;
+  }
+  for (std::map<std::string, const Benchmark::Result *>::iterator it = candidates.begin(); it != candidates.end(); ++it) {
+    std::cout << std::left << std::setw(44) << it->first << std::right << "  missing from baseline" << std::endl;
+  }
+  std::cout << regressions << " regressions, " << improvements << " improvements, " << undecided << " undecided, "
+            << missing << " missing" << std::endl;
+  if (undecided > 0) {
+    std::cerr << "Too few repetitions to reach the significance level " << alpha << " for " << undecided
+              << " benchmarks, more repetitions are needed, e.g. pid_bench -repeat 5"
+              << std::endl;
+  }
+  if (missing > 0) {
+    std::cerr << missing << " benchmarks of the baseline are missing from the candidate"
+              << (allow_missing? ", which -allow_missing allows": "") << std::endl;
+  }
+  // a failing status for scripts gating changes, which also fails when the changes cannot be judged
+  return regressions > 0 || undecided > 0 || (missing > 0 && !allow_missing)? 1: 0;
+}
@@ -0,0 +1,50 @@
+#include <fstream>
+#include <iostream>
+#include <string>
+#include "bench/Benchmark.h"
+#include "bench/benches.h"
+
+int main(int argc, char* argv[]) {
+  int repetitions = 5; // number of repetitions of each benchmark
+  std::string filter = ""; // run benchmarks whose name contain the filter
+  std::string json_file = ""; // the file to write the results to as JSON
+
+  // Process command line options
+  for (int i = 1; i < argc; i++) {
+    if (std::string((argv[i])) == "-repeat") { // repetitions
+      if (sscanf(argv[++i], "%d", &repetitions) != 1 || repetitions <= 0) {
+        std::cerr << "Invalid repetitions: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-filter") { // benchmark name filter
+      filter = argv[++i];
+    } else if (std::string((argv[i])) == "-json") { // JSON results
+      json_file = argv[++i];
+    } else {
+      std::cerr << "Unknown option: " << argv[i] << std::endl;
+      exit(-1);
+    }
+  }
+
+  Benchmark bench(repetitions, filter);
+  quantileBench(bench);
+  reducerBench(bench);
+  pidBankBench(bench);
+  gainScheduleBench(bench);
+  speedCurveBench(bench);
+  steeringBench(bench);
+  trackBench(bench);
+  noiseBench(bench);
+  vehicleBench(bench);
+  twiddleBench(bench);
+  messageBench(bench);
+  bench.report(std::cout);
+  if (!json_file.empty()) {
+    std::ofstream out(json_file.c_str());
+    bench.writeJson(out);
+    if (!out) {
+      std::cerr << "Failed to write results: " << json_file << std::endl;
+      exit(-1);
+    }
+  }
+}
@@ -0,0 +1,92 @@
+#include <algorithm>
+#include "json.hpp"
+#include "ControlParameters.h"
+
+using json = nlohmann::json;
+
+ControlParameters::ControlParameters() {
+  s_coeffs[0] = 0.108;
+  s_coeffs[1] = 3.52;
+  s_coeffs[2] = 0;
+  v_coeffs[0] = 13.5795;
+  v_coeffs[1] = -11.4359;
+  v_coeffs[2] = 0;
+  max_speed = 100;
+  max_accel = 8;
+  max_decel = -20;
+  tau = 0;
+  windup = 0;
+  scheduled = false;
+}
+
+/**
+ * Read PID coefficients from a JSON array of 3 numbers
+ */
+static void readCoefficients(const json &j, const char *name, double coeffs[3]) {
+  if (j.count(name)) {
+    const json &a = j[name];
+    if (!a.is_array() || a.size() != 3) {
+      throw string(name) + " must be an array of kp, kd, and ki";
+    }
+    for (int i = 0; i < 3; i++) {
+      coeffs[i] = a[i].get<double>();
+    }
+  }
+}
+
+/**
+ * Read a number from a JSON object
+ */
+static void readNumber(const json &j, const char *name, double &value) {
+  if (j.count(name)) {
+    if (!j[name].is_number()) {
+      throw string(name) + " must be a number";
+    }
+    value = j[name].get<double>();
+  }
+}
+
+bool ControlParameters::update(const string &text, string &error) {
+  ControlParameters updated(*this);
+  try {
+    json j = json::parse(text);
+    if (!j.is_object()) {
+      throw string("parameters must be a JSON object");
+    }
+    readCoefficients(j, "steering", updated.s_coeffs);
+    readCoefficients(j, "speed", updated.v_coeffs);
+    readNumber(j, "max_speed", updated.max_speed);
+    readNumber(j, "max_accel", updated.max_accel);
+    readNumber(j, "max_decel", updated.max_decel);
+    readNumber(j, "tau", updated.tau);
+    readNumber(j, "windup", updated.windup);
+    if (updated.tau < 0 || updated.windup < 0) {
+      throw string("tau and windup must not be negative");
+    }
+    if (scheduled && (!equal(s_coeffs, s_coeffs + 3, updated.s_coeffs) ||
+                      !equal(v_coeffs, v_coeffs + 3, updated.v_coeffs))) {
+      throw string("the steering and speed coefficients are set by the gain schedule");
+    }
+  } catch (const string &e) {
+    error = e;
+    return false;
+  } catch (const exception &e) {
+    error = e.what();
+    return false;
+  }
+  *this = updated;
+  return true;
+}
+
+string ControlParameters::toJson() const {
+  json j;
+  j["steering"] = {s_coeffs[0], s_coeffs[1], s_coeffs[2]};
+  j["speed"] = {v_coeffs[0], v_coeffs[1], v_coeffs[2]};
+  j["max_speed"] = max_speed;
+  j["max_accel"] = max_accel;
+  j["max_decel"] = max_decel;
+  j["tau"] = tau;
+  j["windup"] = windup;
+  j["scheduled"] = scheduled;
+  return j.dump();
+}
@@ -0,0 +1,47 @@
+#ifndef _CONTROL_CONTROLPARAMETERS_H_
+#define _CONTROL_CONTROLPARAMETERS_H_
+
+#include <string>
+
+using namespace std;
+
+/**
+ * The coefficients and tuning parameters of the controller which can be changed while driving.
+ * They can be updated from a JSON object, the members of the object are all optional:
+ *
+ *     {"steering": [kp, kd, ki], "speed": [kp, kd, ki], "max_speed": 100, "max_accel": 8,
+ *      "max_decel": -20, "tau": 0, "windup": 0}
+ *
+ * While a gain schedule sets the coefficients, updates changing the steering or the speed
+ * coefficients are rejected, as they would have no effect.
+ */
+struct ControlParameters {
+  double s_coeffs[3];   // steering PID coefficients
+  double v_coeffs[3];   // speed PID coefficients
+  double max_speed;     // maximal speed
+  double max_accel;     // maximal acceleration
+  double max_decel;     // maximal deceleration
+  double tau;           // time constant of the derivative filter
+  double windup;        // anti-windup integral limit
+  bool scheduled;       // true if a gain schedule sets the coefficients, which cannot be changed then
+
+  /**
+   * Constructor, sets the default parameters
+   */
+  ControlParameters();
+
+  /**
+   * Update the parameters from a JSON object, the parameters are left unchanged on errors
+   * @param text the JSON text
+   * @param error receives the error message on errors
+   * @return true if successful
+   */
+  bool update(const string &text, string &error);
+
+  /**
+   * Return the parameters as a JSON object
+   */
+  string toJson() const;
+};
+
+#endif
@@ -0,0 +1,179 @@
+#ifndef _CONTROL_DRIVEENGINE_H_
+#define _CONTROL_DRIVEENGINE_H_
+
+#include <math.h>
+#include "ControlParameters.h"
+#include "DriveSettings.h"
+#include "GainSchedule.h"
+#include "SpeedCurve.h"
+#include "SteeringPipeline.h"
+#include "TimedPIDController.h"
+#include "../utils/MathUtils.h"
+#include "../utils/Reducer.h"
+
+using namespace std;
+
+/**
+ * A telemetry message from the simulator. The records are stored as is in telemetry logs, so
+ * the layout must not change
+ */
+struct Telemetry {
+  double time;   // seconds since the first message
+  double cte;    // cross track error
+  double speed;  // speed
+  double angle;  // steering angle in degree
+};
+
+/**
+ * The controls computed for a telemetry message
+ */
+struct DriveControl {
+  double steering;       // the steering value to apply, [-1, 1]
+  double throttle;       // the throttle to apply
+  double target_speed;   // the target speed
+  double accel;          // the acceleration or deceleration to reach the target speed
+  double reduced_angle;  // mean of the past absolute steering angles in degree
+};
+
+/**
+ * DriveEngine computes the steering and throttle of every telemetry message: the steering PID,
+ * the steering stages, the target speed from the mean steering angle, the acceleration PID, and
+ * the throttle. It has no I/O, so the same pipeline drives the simulator, and replays recorded
+ * telemetry as fast as the CPU allows.
+ * The steering stages are the template parameter, see SteeringPipeline.
+ */
+template<class Steering> class DriveEngine {
+  // true if the PIDs take the measured interval between messages
+  bool timed;
+  // the expected interval between messages
+  double nominal_dt;
+  // time of the last message, negative before the first message
+  double last_time;
+
+  // PID controller for steering
+  TimedPIDController<double> pid_steering;
+  // PID controller for acceleration
+  TimedPIDController<double> pid_accel;
+  // Use the mean of past 5 readings to determine the speed of the vehicle
+  Reducer<double> angleReducer;
+  // The steering stages
+  Steering steering;
+
+  // speed dependent coefficients, empty to use the fixed coefficients
+  GainSchedule schedule;
+  // target speed by steering angle
+  SpeedCurve speed_curve;
+
+public:
+  /**
+   * Constructor
+   * @param settings the settings, unless the nominal interval is given, every message is assumed
+   * to arrive after exactly one nominal interval, and the PIDs behave as fixed cadence PIDs
+   */
+  DriveEngine(const DriveSettings &settings): timed(settings.nominal_dt > 0),
+      nominal_dt(timed? settings.nominal_dt: 1), last_time(-1), pid_steering(nominal_dt),
+      pid_accel(nominal_dt), angleReducer(5), schedule(settings.schedule), speed_curve(settings.speed_curve) {
+    const ControlParameters &params = settings.params;
+    pid_steering.init(params.s_coeffs[0], params.s_coeffs[1], params.s_coeffs[2]);
+    pid_accel.init(params.v_coeffs[0], params.v_coeffs[1], params.v_coeffs[2]);
+  }
+
+  /**
+   * Return the steering stages
+   */
+  Steering &getSteering() { return steering; }
+
+  /**
+   * Simple logic to compute throttle from acceleration.
+   * @param accel the acceleration to reach
+   * @param target the target speed
+   * @param max_accel the maximal acceleration
+   * @param max_decel the maximal deceleration
+   */
+  static double computeThrottle(double accel, double target, double max_accel, double max_decel) {
+    // the throttle to keep if no accel, divide by 10 is a rough estimate of target speed,
+    // and throttle to keep for the speed
+    double keep = target / 10.0;
+    if (accel >= 0) { // acceleration
+      if (accel < 0.001) { // small acceleration, keep the mimimal throttle
+        return keep;
+      }
+      else { // otherwise compute the throttle
+        return fmin(1, keep + (1 - keep) * accel / max_accel); // max accel is 5
+      }
+    }
+    else {
+      if (accel <= -2) { // deceleration
+        return -1;
+      }
+
+      return -0.9 + (1 - 0.9) * accel / max_decel;
+    }
+  }
+
+  /**
+   * Compute the controls of a telemetry message
+   * @param t the telemetry message
+   * @param params the coefficients and tuning parameters to apply
+   * @return the controls
+   */
+  DriveControl update(const Telemetry &t, const ControlParameters &params) {
+    // The interval since the last message, limited to 5 nominal intervals so that a pause, e.g. a
+    // reconnection, does not blow up the integrals
+    double dt = nominal_dt;
+    if (timed) {
+      if (last_time >= 0) {
+        dt = fmin(t.time - last_time, 5 * nominal_dt);
+      }
+      last_time = t.time;
+    }
+    double max_speed = params.max_speed;
+    double max_accel = params.max_accel;
+    double max_decel = params.max_decel;
+    pid_steering.setPID(params.s_coeffs[0], params.s_coeffs[1], params.s_coeffs[2]);
+    pid_steering.setDerivativeFilter(params.tau);
+    pid_steering.setIntegralLimit(params.windup);
+    pid_accel.setPID(params.v_coeffs[0], params.v_coeffs[1], params.v_coeffs[2]);
+    pid_accel.setDerivativeFilter(params.tau);
+    pid_accel.setIntegralLimit(params.windup);
+    // Interpolate the coefficients for the current speed
+    if (schedule.size() > 0) {
+      double s_gains[3], v_gains[3];
+      schedule.lookup(t.speed, s_gains, v_gains);
+      pid_steering.setPID(s_gains[0], s_gains[1], s_gains[2]);
+      pid_accel.setPID(v_gains[0], v_gains[1], v_gains[2]);
+    }
+    DriveControl control;
+    // UPdate the steering PID error, and get the PID control value, it needs to be be normalized it to [-1, 1] range
+    double steer_value = clamp(pid_steering.update(t.cte, dt) / MAX_STEERING_ANGLE, -1.0, 1.0);
+
+    // Add the angle to the reducer
+    angleReducer.push(fabs(t.angle));
+
+    // Post-process the steering value
+    control.steering = steering.process(steer_value, t.speed, t.angle);
+
+    // Get the average of the past angle readings
+    control.reduced_angle = angleReducer.mean<double>();
+
+    // Determing the speed from the mean angle
+    control.target_speed = speed_curve.lookup(deg2rad(control.reduced_angle), max_speed);
+    // The scceleration or deceleration
+    double speed_adjustment = control.target_speed - t.speed;
+    // Update the acceleration PID error, and compute the acceleration/deceleration, 1 second to reach the target
+    double accelDecel = pid_accel.update(-speed_adjustment, dt) / 1.0;
+
+    // Clamp the acceleration to [max_decel, max_accel]
+    if (accelDecel > max_accel) {
+      accelDecel =  max_accel;
+    }
+    else if (accelDecel < max_decel) {
+      accelDecel = max_decel;
+    }
+    control.accel = accelDecel;
+    control.throttle = computeThrottle(accelDecel, control.target_speed, max_accel, max_decel);
+    return control;
+  }
+};
+
+#endif
@@ -0,0 +1,111 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include "DriveSettings.h"
+
+DriveSettings::DriveSettings(): nominal_dt(0), stabilize(false), moving_average(false), clamp_delta(false),
+  mean_turn(false), s_given(false), curve_given(false) {}
+
+bool DriveSettings::parseOption(char *argv[], int &i) {
+  double *s_coeffs = params.s_coeffs;
+  double *v_coeffs = params.v_coeffs;
+  if (std::string((argv[i])) == "-s") { // steering PID coefficients
+    s_given = true;
+    if (sscanf(argv[++i], "%lf", &s_coeffs[0]) != 1) {
+      cerr << "Invalid yaw PID coefficient: " << argv[i] << endl;
+      exit(-1);
+    }
+    if (sscanf(argv[++i], "%lf", &s_coeffs[1]) != 1) {
+      cerr << "Invalid yaw PID coefficient: " << argv[i] << endl;
+      exit(-1);
+    }
+    if (sscanf(argv[++i], "%lf", &s_coeffs[2]) != 1) {
+      cerr << "Invalid yaw PID coefficient: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-v") { // vecocity coefficient
+    if (sscanf(argv[++i], "%lf", &v_coeffs[0]) != 1) {
+      cerr << "Invalid veclocity PID coefficient: " << argv[i] << endl;
+      exit(-1);
+    }
+    if (sscanf(argv[++i], "%lf", &v_coeffs[1]) != 1) {
+      cerr << "Invalid veclocity PID coefficient: " << argv[i] << endl;
+      exit(-1);
+    }
+    if (sscanf(argv[++i], "%lf", &v_coeffs[2]) != 1) {
+      cerr << "Invalid veclocity PID coefficient: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-max_speed") { // maximum speed
+    if (sscanf(argv[++i], "%lf", &params.max_speed) != 1) {
+      cerr << "Invalid max speed: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-speed_curve") { // speed curve file
+    curve_given = true;
+    if (!speed_curve.load(argv[++i])) {
+      cerr << "Invalid speed curve: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-schedule") { // gain schedule file
+    if (!schedule.load(argv[++i])) {
+      cerr << "Invalid gain schedule: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-timed") { // time aware PID with the nominal message interval
+    if (sscanf(argv[++i], "%lf", &nominal_dt) != 1 || nominal_dt <= 0) {
+      cerr << "Invalid nominal delta time: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-tau") { // derivative filter time constant
+    if (sscanf(argv[++i], "%lf", &params.tau) != 1 || params.tau < 0) {
+      cerr << "Invalid tau: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-windup") { // integral limit
+    if (sscanf(argv[++i], "%lf", &params.windup) != 1 || params.windup < 0) {
+      cerr << "Invalid windup: " << argv[i] << endl;
+      exit(-1);
+    }
+  } else if (std::string((argv[i])) == "-stabilize") { // stabilize the motion
+    stabilize = true;
+  } else if (std::string((argv[i])) == "-moving_average") { // moving average of steering values
+    moving_average = true;
+  } else if (std::string((argv[i])) == "-clamp_delta") { // clamp changes of steering values
+    clamp_delta = true;
+  } else if (std::string((argv[i])) == "-mean_turn") { // stabilize with turns
+    mean_turn = true;
+  } else {
+    return false;
+  }
+  return true;
+}
+
+void DriveSettings::finish() {
+  // Stabilization uses moving average of steering values, and clamping changes and mean turn only
+  // apply to stabilization
+  if (stabilize) {
+    moving_average = true;
+  } else if (clamp_delta || mean_turn) {
+    cerr << "-clamp_delta and -mean_turn require -stabilize" << endl;
+    exit(-1);
+  }
+
+  // the steering coefficients and the speed curve default to the ones tuned for the steering stages
+  double *s_coeffs = params.s_coeffs;
+  if (!s_given) {
+    if (stabilize) {
+      s_coeffs[0] = 0.13; s_coeffs[1] = 4; s_coeffs[2] = 0;
+    } else if (moving_average) {
+      s_coeffs[0] = 0.075; s_coeffs[1] = 2.5; s_coeffs[2] = 0;
+    } else {
+      s_coeffs[0] = 0.108; s_coeffs[1] = 3.52; s_coeffs[2] = 0; // {0.119058, 3.23448, 0};
+    }
+  }
+  if (!curve_given) {
+    speed_curve = stabilize? SpeedCurve::stabilized():
+        (moving_average? SpeedCurve::movingAverage(): SpeedCurve::plain());
+  }
+  // the coefficients of a gain schedule cannot be updated while driving
+  params.scheduled = schedule.size() > 0;
+}
@@ -0,0 +1,70 @@
+#ifndef _CONTROL_DRIVESETTINGS_H_
+#define _CONTROL_DRIVESETTINGS_H_
+
+#include "ControlParameters.h"
+#include "GainSchedule.h"
+#include "SpeedCurve.h"
+#include "SteeringPipeline.h"
+
+using namespace std;
+
+/**
+ * Settings of the driving pipeline given on the command line, shared by the PID controller that
+ * drives the simulator, and by the replay of recorded telemetry, so that both run exactly the
+ * same pipeline for the same options.
+ */
+struct DriveSettings {
+  ControlParameters params; // the initial coefficients and tuning parameters
+  double nominal_dt;        // the expected interval between messages, 0 to ignore the measured interval
+  GainSchedule schedule;    // speed dependent coefficients, empty to use the fixed coefficients
+  SpeedCurve speed_curve;   // target speed by steering angle
+
+  // Steering stages
+  bool stabilize;       // stabilize the motion
+  bool moving_average;  // moving average of steering values
+  bool clamp_delta;     // clamp changes of steering values
+  bool mean_turn;       // stabilize with turns instead of steering angles
+
+  bool s_given;         // true if the steering coefficients are given
+  bool curve_given;     // true if the speed curve is given
+
+  /**
+   * Constructor, sets the default settings
+   */
+  DriveSettings();
+
+  /**
+   * Parse a command line option of the driving pipeline. The program exits on invalid values
+   * @param argv the arguments
+   * @param i index of the option, it is advanced to the last value of the option
+   * @return true if the option is a driving pipeline option
+   */
+  bool parseOption(char *argv[], int &i);
+
+  /**
+   * Check the steering stages, and apply the defaults of the selected stages once all the options
+   * are parsed. The program exits on invalid combinations
+   */
+  void finish();
+
+  /**
+   * Call a function with a steering pipeline of the selected stages, the function takes the
+   * pipeline type from its argument, e.g. [&](auto steering) { run<decltype(steering)>(); }
+   * @param f the function
+   */
+  template<class F> void withSteering(F f) const {
+    if (stabilize) {
+      if (clamp_delta) {
+        mean_turn? f(SteeringPipeline<true, true, true, true>()): f(SteeringPipeline<true, true, true, false>());
+      } else {
+        mean_turn? f(SteeringPipeline<true, true, false, true>()): f(SteeringPipeline<true, true, false, false>());
+      }
+    } else if (moving_average) {
+      f(SteeringPipeline<false, true, false, false>());
+    } else {
+      f(SteeringPipeline<false, false, false, false>());
+    }
+  }
+};
+
+#endif
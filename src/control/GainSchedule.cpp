@@ -0,0 +1,79 @@
+#include <stdint.h>
+#include <string.h>
+#include <fstream>
+#include "GainSchedule.h"
+
+static const char MAGIC[4] = {'G', 'S', 'C', 'H'};
+static const uint32_t VERSION = 1;
+
+GainSchedule::GainSchedule(): count(0), speed_min(0), speed_step(1) {}
+
+GainSchedule::GainSchedule(double speed_min, double speed_step, int count):
+  count(count), speed_min(speed_min), speed_step(speed_step), gains(count * GAINS, 0) {}
+
+void GainSchedule::set(int index, const double steering[3], const double throttle[3]) {
+  if (index < 0 || index >= count) {
+    throw "Index out of bound";
+  }
+  double *g = &gains[index * GAINS];
+  for (int i = 0; i < 3; i++) {
+    g[i] = steering[i];
+    g[i + 3] = throttle[i];
+  }
+}
+
+void GainSchedule::lookup(double speed, double steering[3], double throttle[3]) const {
+  if (count == 0) {
+    return;
+  }
+  // position of the speed on the grid, clamped to the grid
+  double t = (speed - speed_min) / speed_step;
+  if (!(t > 0)) t = 0;
+  if (t > count - 1) t = count - 1;
+  int i = count > 1? int(t): 0;
+  if (i > count - 2) i = count > 1? count - 2: 0;
+  double f = t - i;
+  const double *a = &gains[i * GAINS];
+  const double *b = count > 1? a + GAINS: a;
+  for (int k = 0; k < 3; k++) {
+    steering[k] = a[k] + f * (b[k] - a[k]);
+    throttle[k] = a[k + 3] + f * (b[k + 3] - a[k + 3]);
+  }
+}
+
+bool GainSchedule::save(const string &path) const {
+  ofstream out(path.c_str(), ios::binary);
+  if (!out) {
+    return false;
+  }
+  uint32_t n = count;
+  out.write(MAGIC, sizeof(MAGIC));
+  out.write((const char *)&VERSION, sizeof(VERSION));
+  out.write((const char *)&n, sizeof(n));
+  out.write((const char *)&speed_min, sizeof(speed_min));
+  out.write((const char *)&speed_step, sizeof(speed_step));
+  out.write((const char *)gains.data(), gains.size() * sizeof(double));
+  return bool(out);
+}
+
+bool GainSchedule::load(const string &path) {
+  ifstream in(path.c_str(), ios::binary);
+  char magic[4];
+  uint32_t version, n;
+  double min, step;
+  if (!in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      !in.read((char *)&version, sizeof(version)) || version != VERSION ||
+      !in.read((char *)&n, sizeof(n)) || n == 0 ||
+      !in.read((char *)&min, sizeof(min)) || !in.read((char *)&step, sizeof(step)) || !(step > 0)) {
+    return false;
+  }
+  vector<double> values(n * GAINS);
+  if (!in.read((char *)values.data(), values.size() * sizeof(double))) {
+    return false;
+  }
+  count = n;
+  speed_min = min;
+  speed_step = step;
+  gains.swap(values);
+  return true;
+}
@@ -0,0 +1,93 @@
+#ifndef _CONTROL_GAINSCHEDULE_H_
+#define _CONTROL_GAINSCHEDULE_H_
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * GainSchedule maps speed to the steering and throttle PID coefficients. The coefficients are
+ * tabulated on a uniform speed grid, so a lookup finds its grid cell with one multiplication,
+ * and linearly interpolates the coefficients of the two ends of the cell.
+ * The schedule is stored in a compact binary file: a header with the magic "GSCH", the version,
+ * the number of grid points, the lowest speed and the speed step, followed by the coefficients
+ * of every grid point in the order of steering kp, kd, ki, and throttle kp, kd, ki.
+ */
+class GainSchedule {
+public:
+  // number of coefficients per grid point
+  static const int GAINS = 6;
+
+private:
+  // number of grid points
+  int count;
+  // speed of the first grid point
+  double speed_min;
+  // speed between grid points
+  double speed_step;
+  // coefficients of the grid points, GAINS per point
+  vector<double> gains;
+
+public:
+  /**
+   * Constructor, constructs an empty schedule
+   */
+  GainSchedule();
+
+  /**
+   * Constructor
+   * @param speed_min speed of the first grid point
+   * @param speed_step speed between grid points
+   * @param count number of grid points
+   */
+  GainSchedule(double speed_min, double speed_step, int count);
+
+  /**
+   * Return the number of grid points
+   */
+  int size() const { return count;}
+
+  /**
+   * Return speed of the first grid point
+   */
+  double getMinSpeed() const { return speed_min;}
+
+  /**
+   * Return speed between grid points
+   */
+  double getSpeedStep() const { return speed_step;}
+
+  /**
+   * Set the coefficients of a grid point
+   * @param index index of the grid point
+   * @param steering the steering kp, kd, ki
+   * @param throttle the throttle kp, kd, ki
+   */
+  void set(int index, const double steering[3], const double throttle[3]);
+
+  /**
+   * Look up the coefficients for a speed, the coefficients are interpolated between grid points,
+   * and speeds beyond the grid are clamped to it
+   * @param speed the speed
+   * @param steering receives the steering kp, kd, ki
+   * @param throttle receives the throttle kp, kd, ki
+   */
+  void lookup(double speed, double steering[3], double throttle[3]) const;
+
+  /**
+   * Save the schedule to a binary file
+   * @param path the file path
+   * @return true if successful
+   */
+  bool save(const string &path) const;
+
+  /**
+   * Load the schedule from a binary file
+   * @param path the file path
+   * @return true if successful
+   */
+  bool load(const string &path);
+};
+
+#endif
@@ -0,0 +1,63 @@
+#ifndef _CONTROL_MESSAGES_H_
+#define _CONTROL_MESSAGES_H_
+
+#include <string>
+#include "json.hpp"
+#include "DriveEngine.h"
+
+using namespace std;
+using json = nlohmann::json;
+
+// The SocketIO messages exchanged with the simulator
+
+/**
+ * Checks if the SocketIO event has JSON data.
+ * If there is data the JSON object in string format will be returned,
+ * else the empty string "" will be returned.
+ * @param s the message
+ */
+inline string hasData(const string &s) {
+  auto found_null = s.find("null");
+  auto b1 = s.find_first_of("[");
+  auto b2 = s.find_last_of("]");
+  if (found_null != string::npos) {
+    return "";
+  }
+  else if (b1 != string::npos && b2 != string::npos) {
+    return s.substr(b1, b2 - b1 + 1);
+  }
+  return "";
+}
+
+/**
+ * Read the telemetry of an event, all but the time
+ * @param j the event, an array of the event name and the data JSON object
+ * @param t receives the telemetry
+ * @return true if the event is telemetry
+ */
+inline bool parseTelemetry(const json &j, Telemetry &t) {
+  if (j[0].get<string>() != "telemetry") {
+    return false;
+  }
+  // j[1] is the data JSON object
+  t.cte = stod(j[1]["cte"].get<string>());
+  t.speed = stod(j[1]["speed"].get<string>());
+  // what is the steering angle from the simulator? and the unit, is it the yaw instead?
+  // As it is very off from values sent to the simulator
+  t.angle = stod(j[1]["steering_angle"].get<string>());
+  return true;
+}
+
+/**
+ * Return the message that sends the controls to the simulator
+ * @param steering the steering value
+ * @param throttle the throttle
+ */
+inline string steerMessage(double steering, double throttle) {
+  json msgJson;
+  msgJson["steering_angle"] = steering;
+  msgJson["throttle"] = throttle;
+  return "42[\"steer\"," + msgJson.dump() + "]";
+}
+
+#endif
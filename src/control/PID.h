@@ -1,19 +1,14 @@
 #ifndef _CONTROL_PID_H_
 #define _CONTROL_PID_H_
 
-class PID {
-  bool initial = true;
-  double target;     // control target
-  double error;      // the error
-  double error_sum;  // sum of error
-  double derror;     // error derivative
+#include "PIDController.h"
 
-  /*
-  * Coefficients
-  */
-  double Kp;  // Proprotional control coefficient
-  double Ki;  // Integral control coefficient
-  double Kd;  // Derivative control coefficient
+/**
+ * The PID controller. This is a compatibility wrapper around PIDController<double>, which should
+ * be used on the hot paths instead.
+ */
+class PID {
+  PIDController<double> controller;
 
  public:
   /*
@@ -29,22 +24,22 @@ class PID {
   /**
    * Set the control's target value
    */
-  void setTarget(double value) { target = value; };
+  void setTarget(double value) { controller.setTarget(value); };
 
   /**
    * Return the control's target
    */
-  double getTarget() { return target; };
+  double getTarget() { return controller.getTarget(); };
 
   /**
    * Update the value under control
    */
-  void updateValue(double value) { updateError(value - target); };
+  void updateValue(double value) { updateError(value - getTarget()); };
 
   /*
   * Initialize PID.
   */
-  void init(double Kp, double Ki, double Kd);
+  void init(double Kp, double Kd, double Ki);
 
   /**
    * Set the coefficients without re-initializing the PID
@@ -54,7 +49,7 @@ class PID {
   /**
    * Return current error
    */ 
-  double getError() { return error;}
+  double getError() { return controller.getError();}
 
   /*
   * Update the PID error variables given cross track error.
@@ -0,0 +1,85 @@
+#include <cstddef>
+#include "PIDBank.h"
+
+/*
+* The kernels below take every array as a restricted pointer, so that the compiler knows they
+* do not alias, and vectorizes the loops.
+*/
+
+/**
+ * Update the errors, the values are offset by the targets, or used as is if targets is NULL
+ */
+static void updateKernel(size_t n, const double *__restrict values, const double *__restrict targets,
+    double *__restrict first, double *__restrict e, double *__restrict sum, double *__restrict d) {
+  for (size_t i = 0; i < n; i++) {
+    double value = targets? values[i] - targets[i]: values[i];
+    // the first error has no derivative, same as PID::updateError
+    double last = first[i] != 0? value: e[i];
+    first[i] = 0;
+    d[i] = value - last;
+    sum[i] += value;
+    e[i] = value;
+  }
+}
+
+/**
+ * Compute the controls from the errors
+ */
+static void controlKernel(size_t n, double *__restrict controls, const double *__restrict e,
+    const double *__restrict sum, const double *__restrict d, const double *__restrict p,
+    const double *__restrict in, const double *__restrict de) {
+  for (size_t i = 0; i < n; i++) {
+    controls[i] = -p[i] * e[i] - de[i] * d[i] - in[i] * sum[i];
+  }
+}
+
+/**
+ * Update the errors and compute the controls in one pass
+ */
+static void updateAndControlKernel(size_t n, const double *__restrict values, double *__restrict controls,
+    double *__restrict first, double *__restrict e, double *__restrict sum, double *__restrict d,
+    const double *__restrict p, const double *__restrict in, const double *__restrict de) {
+  for (size_t i = 0; i < n; i++) {
+    double value = values[i];
+    double last = first[i] != 0? value: e[i];
+    first[i] = 0;
+    d[i] = value - last;
+    sum[i] += value;
+    e[i] = value;
+    controls[i] = -p[i] * value - de[i] * d[i] - in[i] * sum[i];
+  }
+}
+
+PIDBank::PIDBank(size_t size): n(size), initial(size, 1), target(size, 0), error(size, 0),
+  error_sum(size, 0), derror(size, 0), Kp(size, 0), Ki(size, 0), Kd(size, 0) {}
+
+void PIDBank::init(size_t i, double Kp, double Kd, double Ki) {
+  setPID(i, Kp, Kd, Ki);
+  error[i] = 0;
+  error_sum[i] = 0;
+  derror[i] = 0;
+  initial[i] = 1;
+}
+
+void PIDBank::setPID(size_t i, double Kp, double Kd, double Ki) {
+  this->Kp[i] = Kp;
+  this->Ki[i] = Ki;
+  this->Kd[i] = Kd;
+}
+
+void PIDBank::updateErrors(const double *values) {
+  updateKernel(n, values, NULL, initial.data(), error.data(), error_sum.data(), derror.data());
+}
+
+void PIDBank::updateValues(const double *values) {
+  updateKernel(n, values, target.data(), initial.data(), error.data(), error_sum.data(), derror.data());
+}
+
+void PIDBank::getControls(double *controls) {
+  controlKernel(n, controls, error.data(), error_sum.data(), derror.data(), Kp.data(), Ki.data(), Kd.data());
+}
+
+void PIDBank::update(const double *values, double *controls) {
+  updateAndControlKernel(n, values, controls, initial.data(), error.data(), error_sum.data(), derror.data(),
+                         Kp.data(), Ki.data(), Kd.data());
+}
@@ -0,0 +1,97 @@
+#ifndef _CONTROL_PIDBANK_H_
+#define _CONTROL_PIDBANK_H_
+
+#include <vector>
+
+using namespace std;
+
+/**
+ * PIDBank holds a number of PID controllers in structure of arrays layout, so that errors and
+ * controls of all the controllers are updated in one pass over contiguous arrays which the compiler
+ * can vectorize. Every controller in the bank produces exactly the same numbers as a PID object
+ * initialized with the same coefficients and fed with the same values.
+ */
+class PIDBank {
+  size_t n;                 // number of controllers
+  vector<double> initial;   // 1 if the controller has not received any error yet, 0 otherwise
+  vector<double> target;    // control targets
+  vector<double> error;     // the errors
+  vector<double> error_sum; // sums of error
+  vector<double> derror;    // error derivatives
+
+  /*
+  * Coefficients
+  */
+  vector<double> Kp;  // Proprotional control coefficients
+  vector<double> Ki;  // Integral control coefficients
+  vector<double> Kd;  // Derivative control coefficients
+
+ public:
+  /*
+  * Constructor
+  * @param size number of controllers in the bank
+  */
+  PIDBank(size_t size);
+
+  /**
+   * Return the number of controllers in the bank
+   */
+  size_t size() { return n;}
+
+  /*
+  * Initialize a controller in the bank.
+  * @param i index of the controller
+  */
+  void init(size_t i, double Kp, double Kd, double Ki);
+
+  /**
+   * Set the coefficients of a controller without re-initializing it
+   * @param i index of the controller
+   */
+  void setPID(size_t i, double Kp, double Kd, double Ki);
+
+  /**
+   * Set a controller's target value
+   * @param i index of the controller
+   */
+  void setTarget(size_t i, double value) { target[i] = value; };
+
+  /**
+   * Return a controller's target
+   * @param i index of the controller
+   */
+  double getTarget(size_t i) { return target[i]; };
+
+  /**
+   * Return current error of a controller
+   * @param i index of the controller
+   */
+  double getError(size_t i) { return error[i];}
+
+  /*
+  * Update the errors of all the controllers
+  * @param values the errors, one per controller
+  */
+  void updateErrors(const double *values);
+
+  /**
+   * Update the values under control of all the controllers, errors are computed from the targets
+   * @param values the values, one per controller
+   */
+  void updateValues(const double *values);
+
+  /*
+  * Calculate the control values of all the controllers
+  * @param controls receives the control values, one per controller
+  */
+  void getControls(double *controls);
+
+  /**
+   * Update the errors, and calculate the control values of all the controllers in one pass
+   * @param values the errors, one per controller
+   * @param controls receives the control values, one per controller
+   */
+  void update(const double *values, double *controls);
+};
+
+#endif
@@ -0,0 +1,116 @@
+#ifndef _CONTROL_PIDCONTROLLER_H_
+#define _CONTROL_PIDCONTROLLER_H_
+
+/**
+ * Header only PID controller for the hot paths, templated on the scalar type. It computes the
+ * same numbers as PID, but is final and has no virtual methods, and all of its methods are
+ * constexpr inline functions, so a control loop compiles to straight-line arithmetic.
+ * update() and updateValue() fuse the error update and the control computation in one call.
+ */
+template<typename T> class PIDController final {
+  bool initial;  // true if no error has been received
+  T target;     // control target
+  T error;      // the error
+  T error_sum;  // sum of error
+  T derror;     // error derivative
+
+  /*
+  * Coefficients
+  */
+  T Kp;  // Proprotional control coefficient
+  T Ki;  // Integral control coefficient
+  T Kd;  // Derivative control coefficient
+
+ public:
+  /*
+  * Constructor
+  */
+  constexpr PIDController(): initial(true), target(0), error(0), error_sum(0), derror(0), Kp(0), Ki(0), Kd(0) {}
+
+  /*
+  * Constructor
+  * @param Kp the proportional coefficient
+  * @param Kd the derivative coefficient
+  * @param Ki the integral coefficient
+  */
+  constexpr PIDController(T Kp, T Kd, T Ki):
+    initial(true), target(0), error(0), error_sum(0), derror(0), Kp(Kp), Ki(Ki), Kd(Kd) {}
+
+  /**
+   * Set the control's target value
+   */
+  constexpr void setTarget(T value) { target = value; }
+
+  /**
+   * Return the control's target
+   */
+  constexpr T getTarget() const { return target; }
+
+  /*
+  * Initialize PID.
+  */
+  constexpr void init(T Kp, T Kd, T Ki) {
+    setPID(Kp, Kd, Ki);
+    error = 0;
+    error_sum = 0;
+    derror = 0;
+    initial = true;
+  }
+
+  /**
+   * Set the coefficients without re-initializing the PID
+   */
+  constexpr void setPID(T Kp, T Kd, T Ki) {
+    this->Kp = Kp;
+    this->Ki = Ki;
+    this->Kd = Kd;
+  }
+
+  /**
+   * Return current error
+   */
+  constexpr T getError() const { return error; }
+
+  /*
+  * Update the PID error variables given cross track error.
+  * @param value the error
+  */
+  constexpr void updateError(T value) {
+    if (initial) {
+      initial = false;
+      error = value;
+    }
+
+    // No need to divide it by dt, as if we do so, kd will just be scaled down proportionally
+    derror = value - error;
+    // No need to multiply it by dt, as if we do so, ki will just be scaled up proprotionally
+    error_sum += value;
+    error = value;
+  }
+
+  /*
+  * Calculate the PID control value to apply.
+  */
+  constexpr T getControl() const {
+    return -Kp * error - Kd * derror - Ki * error_sum;
+  }
+
+  /**
+   * Update the error, and return the control value to apply
+   * @param value the error
+   */
+  constexpr T update(T value) {
+    updateError(value);
+    return getControl();
+  }
+
+  /**
+   * Update the value under control, and return the control value to apply
+   * @param value the value, the error is computed from the target
+   */
+  constexpr T updateValue(T value) {
+    return update(value - target);
+  }
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include <vector>
+#include "SpeedCurve.h"
+
+SpeedCurve::SpeedCurve() {
+  *this = plain();
+}
+
+SpeedCurve::SpeedCurve(const double *bounds, const double *speeds, int steps) {
+  if (steps <= 0 || steps > MAX_STEPS) {
+    throw "Invalid number of steps";
+  }
+  // the last bound is not needed, as the last step applies to all the angles beyond the bound before it
+  int count = steps - 1;
+  for (int i = 1; i < count; i++) {
+    if (!(bounds[i] > bounds[i - 1])) {
+      throw "Speed curve bounds are not ascending";
+    }
+  }
+  // the buckets cover the angles up to the last bound
+  scale = count > 0 && bounds[count - 1] > 0? BUCKETS / bounds[count - 1]: 0;
+  for (int b = 0; b < BUCKETS; b++) {
+    base[b] = 0;
+    first[b] = INFINITY;
+    second[b] = INFINITY;
+  }
+  for (int i = 0; i < count; i++) {
+    // bucket() is monotonic, so every angle in a bucket after the bound's bucket passes the bound,
+    // and every angle in a bucket before does not. Only the angles in the same bucket need comparison
+    // bounds not greater than 0 are passed by every angle
+    int b = bounds[i] > 0? bucket(bounds[i]): -1;
+    for (int k = b + 1; k < BUCKETS; k++) {
+      base[k]++;
+    }
+    if (b < 0) {
+      continue;
+    } else if (isinf(first[b])) {
+      first[b] = bounds[i];
+    } else if (isinf(second[b])) {
+      second[b] = bounds[i];
+    } else {
+      throw "Speed curve bounds are too close";
+    }
+  }
+  for (int i = 0; i < MAX_STEPS + 2; i++) {
+    this->speeds[i] = speeds[i < steps? i: steps - 1];
+  }
+}
+
+SpeedCurve SpeedCurve::plain() {
+  static const double bounds[] = {0.02, 0.075, 0.0875, 0.12, 0.13, 0.14, 0.3, 0.5, INFINITY};
+  static const double speeds[] = {INFINITY, 95, 90, 85, 60, 35, 30, 25, 20};
+  return SpeedCurve(bounds, speeds, sizeof(bounds) / sizeof(bounds[0]));
+}
+
+SpeedCurve SpeedCurve::movingAverage() {
+  static const double bounds[] = {0.02, 0.075, 0.0875, 0.12, 0.13, 0.14, 0.3, 0.5, INFINITY};
+  static const double speeds[] = {INFINITY, 95, 90, 55, 40, 35, 30, 25, 20};
+  return SpeedCurve(bounds, speeds, sizeof(bounds) / sizeof(bounds[0]));
+}
+
+SpeedCurve SpeedCurve::stabilized() {
+  static const double bounds[] = {0.02, 0.075, 0.1, 0.12, 0.125, 0.3, 0.5, INFINITY};
+  static const double speeds[] = {INFINITY, 95, 90, 85, 40, 30, 25, 20};
+  return SpeedCurve(bounds, speeds, sizeof(bounds) / sizeof(bounds[0]));
+}
+
+bool SpeedCurve::load(const string &path) {
+  ifstream in(path.c_str());
+  if (!in) {
+    return false;
+  }
+  vector<double> file_bounds;
+  vector<double> file_speeds;
+  string line;
+  while (getline(in, line)) {
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == string::npos || line[start] == '#') {
+      continue;
+    }
+    double bound, speed;
+    char word[16];
+    if (sscanf(line.c_str(), "%lf %15s", &bound, word) != 2) {
+      return false;
+    }
+    if (strcmp(word, "max") == 0) {
+      speed = INFINITY;
+    } else if (sscanf(word, "%lf", &speed) != 1) {
+      return false;
+    }
+    if (!file_bounds.empty() && !(bound > file_bounds.back())) { // bounds must be ascending
+      return false;
+    }
+    file_bounds.push_back(bound);
+    file_speeds.push_back(speed);
+  }
+  if (file_bounds.empty() || file_bounds.size() > MAX_STEPS) {
+    return false;
+  }
+  try {
+    *this = SpeedCurve(file_bounds.data(), file_speeds.data(), file_bounds.size());
+  } catch (const char *) {
+    return false;
+  }
+  return true;
+}
@@ -0,0 +1,103 @@
+#ifndef _CONTROL_SPEEDCURVE_H_
+#define _CONTROL_SPEEDCURVE_H_
+
+#include <math.h>
+#include <string>
+
+using namespace std;
+
+/**
+ * SpeedCurve maps the steering angle to the target speed with a step table: the target speed of
+ * an angle is the speed of the first step whose angle bound is greater than the absolute angle.
+ * Instead of comparing the angle with the bounds one by one, the angles are divided into uniform
+ * buckets, every bucket has the number of bounds before it, and the at most two bounds within it.
+ * So a lookup computes the bucket with one multiplication, and the step with two comparisons
+ * without any branch. Bounds that are too close to be separated by the buckets are rejected.
+ *
+ * A curve can be loaded from a text file, where every line has the angle bound in radians and the
+ * speed of a step, ordered by the bound. The bound may be inf, and the speed may be max for no
+ * limit. Angles beyond the last bound take the speed of the last step. Lines starting with #
+ * are comments. For example:
+ *
+ *     # bound speed
+ *     0.02    max
+ *     0.3     30
+ *     inf     20
+ */
+class SpeedCurve {
+public:
+  // maximal number of steps
+  static const int MAX_STEPS = 16;
+  // number of buckets
+  static const int BUCKETS = 256;
+
+private:
+  // buckets per radian
+  double scale;
+  // number of bounds in the buckets before each bucket
+  int base[BUCKETS];
+  // the bounds in each bucket, padded with infinity
+  double first[BUCKETS];
+  double second[BUCKETS];
+  // the speeds, speeds[i] for angles passing i bounds, padded with the last speed
+  double speeds[MAX_STEPS + 2];
+
+  /**
+   * Return the bucket of an absolute angle, NaN and angles beyond the buckets go to the last bucket
+   */
+  int bucket(double y) const {
+    double t = y * scale;
+    return t < BUCKETS? int(t): BUCKETS - 1;
+  }
+
+public:
+  /**
+   * Constructor, constructs the default curve
+   */
+  SpeedCurve();
+
+  /**
+   * Constructor
+   * @param bounds the angle bounds in ascending order, the last one may be infinity
+   * @param speeds the speed of every step, INFINITY for no limit
+   * @param steps number of steps, at most MAX_STEPS
+   * @throw if the bounds are not ascending, or are too close to each other
+   */
+  SpeedCurve(const double *bounds, const double *speeds, int steps);
+
+  /**
+   * Return the curve used with the fixed coefficient PID steering
+   */
+  static SpeedCurve plain();
+
+  /**
+   * Return the curve used with moving average steering
+   */
+  static SpeedCurve movingAverage();
+
+  /**
+   * Return the curve used with motion stabilization
+   */
+  static SpeedCurve stabilized();
+
+  /**
+   * Load the curve from a text file
+   * @param path the file path
+   * @return true if successful
+   */
+  bool load(const string &path);
+
+  /**
+   * Return the target speed for a steering angle
+   * @param angle the angle in radian
+   * @param max the maximal speed permitted
+   */
+  double lookup(double angle, double max) const {
+    double y = fabs(angle);
+    int b = bucket(y);
+    int index = base[b] + !(y < first[b]) + !(y < second[b]);
+    return fmin(max, speeds[index]);
+  }
+};
+
+#endif
@@ -0,0 +1,137 @@
+#ifndef _CONTROL_STEERINGPIPELINE_H_
+#define _CONTROL_STEERINGPIPELINE_H_
+
+#include <math.h>
+#include <iostream>
+#include "../utils/MathUtils.h"
+#include "../utils/Reducer.h"
+
+using namespace std;
+
+// Maximal steering angle, +- 27 degree.
+static const double MAX_STEERING_ANGLE = 27 * M_PI / 180;
+
+/**
+ * SteeringPipeline post-processes the normalized steering value produced by the steering PID to
+ * reduce oscillation. The stages of the pipeline are selected with the template parameters, the
+ * disabled stages are compile time constant false branches which the compiler removes, so every
+ * combination of stages runs as fast as a program written for just that combination.
+ * The stages are:
+ *   STABILIZE: subtract the moving average of the past steering angles or turns from the moving
+ *              average of the steering values, this implies MOVING_AVERAGE.
+ *   MOVING_AVERAGE: weighted moving average of the steering values.
+ *   CLAMP_DELTA: clamp large changes of the steering value, only with STABILIZE.
+ *   MEAN_TURN: stabilize with the turns instead of the steering angles, only with STABILIZE.
+ */
+template<bool STABILIZE, bool MOVING_AVERAGE, bool CLAMP_DELTA, bool MEAN_TURN> class SteeringPipeline {
+public:
+  // Maximal change in steering
+  static constexpr double MAX_STEERING_CHANGE = 0.5;
+  // Length of the car to compute turns
+  static constexpr double CAR_LENGTH = 2.5;
+  // Number of samples needed before the stabilization starts
+  static const int STABILIZE_SAMPLES = 200;
+
+private:
+  // Moving average of steering values
+  Reducer<double> steerReducer;
+  // Moving average of steering angles or turns
+  Reducer<double> stabilizeReducer;
+  // Moving average of speeds
+  Reducer<double> speedReducer;
+  // The stabilization offset of the last steering value
+  double steer_offset;
+
+  /**
+   * Weights of the moving average of steering values
+   */
+  static const double *steeringWeights() {
+    static const double weights[] = {1, 2, 3, 5, 7, 9, 11, 13};
+    return weights;
+  }
+
+public:
+  SteeringPipeline(): steerReducer(5), stabilizeReducer(30), speedReducer(30), steer_offset(0) {}
+
+  /**
+   * Return true if the steering values are being stabilized
+   */
+  bool isStabilizing() {
+    return STABILIZE && stabilizeReducer.getNumberOfSamplesReceived() >= STABILIZE_SAMPLES;
+  }
+
+  /**
+   * Process a steering value
+   * @param steer_value the steering value from the PID normalized to [-1, 1]
+   * @param speed the current speed
+   * @param angle the current steering angle in degree
+   * @return the steering value to apply
+   */
+  double process(double steer_value, double speed, double angle) {
+    if (STABILIZE) {
+      // Apply a low pass filter once we have enough samples
+      if (CLAMP_DELTA && steerReducer.size() > 0) {
+        double delta = steer_value - steerReducer[steerReducer.size() - 1];
+        if (fabs(delta) > MAX_STEERING_CHANGE) { // too much change, clamp it
+          steer_value = steerReducer[steerReducer.size() - 1] + delta < 0? -MAX_STEERING_CHANGE: MAX_STEERING_CHANGE;
+        }
+      }
+      steerReducer.push(steer_value);
+      double radian = deg2rad(angle);
+      if (MEAN_TURN) {
+        // Compute turing angle from steering angle
+        double turn = tan(radian) * speed / CAR_LENGTH;
+        stabilizeReducer.push(turn);
+        speedReducer.push(speed);
+      } else {
+        // Add the angle to the reducer
+        stabilizeReducer.push(radian);
+      }
+      if (stabilizeReducer.getNumberOfSamplesReceived() >= STABILIZE_SAMPLES) { // we have enough samples to begin with
+        // Get the average steering value and clamp to [-1, 1]
+        steer_value = steerReducer.mean<double>(steeringWeights());
+        steer_value = clamp(steer_value, -1.0, 1.0);
+        if (MEAN_TURN) {
+          // Stabilize with the average turn, use it and the average speed to compute the steering offset
+          double turn = stabilizeReducer.mean<double>();
+          turn *= CAR_LENGTH/speedReducer.mean<double>();
+          steer_offset = -atan(turn) / MAX_STEERING_ANGLE;
+        } else {
+          // Regularize steering with moving angle average to reduce oscillation caused by overshots
+          steer_offset = -stabilizeReducer.mean<double>() / MAX_STEERING_ANGLE;
+        }
+        steer_value += steer_offset;
+        // Clamp steering value to [-1, 1] range
+        steer_value = clamp(steer_value, -1.0, 1.0);
+      }
+    } else if (MOVING_AVERAGE) {
+      steerReducer.push(steer_value);
+      if (steerReducer.getNumberOfSamplesReceived() >= steerReducer.getLimit()) {
+        steer_value = steerReducer.mean<double>(steeringWeights());
+        steer_value = clamp(steer_value, -1.0, 1.0);
+      }
+    }
+    return steer_value;
+  }
+
+  /**
+   * Write a csv line of the last processed steering value
+   * @param out the stream to write to
+   * @param steer_value the steering value returned by process()
+   * @param angle the current steering angle in degree
+   * @param cte the current cross track error
+   * @param speed the current speed
+   */
+  void csv(ostream &out, double steer_value, double angle, double cte, double speed) {
+    if (STABILIZE) {
+      if (isStabilizing()) {
+        out << steer_offset << "," << steer_value << "," << deg2rad(angle) << "," << cte << "," << speed
+            << "," << steerReducer[steerReducer.size() - 1] << endl;
+      }
+    } else {
+      out << steer_value << "," << deg2rad(angle) << "," << cte << "," << speed  << endl;
+    }
+  }
+};
+
+#endif
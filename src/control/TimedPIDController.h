@@ -0,0 +1,163 @@
+#ifndef _CONTROL_TIMEDPIDCONTROLLER_H_
+#define _CONTROL_TIMEDPIDCONTROLLER_H_
+
+/**
+ * Header only time aware PID controller, templated on the scalar type. Unlike PIDController
+ * which assumes errors arrive at a fixed cadence, every update takes the measured delta time.
+ * The coefficients keep the same per step meaning as PIDController's: the derivative is
+ * normalized to the nominal delta time, and the integral is accumulated in units of nominal
+ * steps. So with updates arriving exactly every nominal delta time, no derivative filter, and
+ * no integral limit, it produces the same numbers as PIDController.
+ * In addition, the derivative can be smoothed with a first order low pass filter, and the
+ * integral can be clamped to prevent windup.
+ */
+template<typename T> class TimedPIDController final {
+  bool initial;  // true if no error has been received
+  T target;     // control target
+  T error;      // the error
+  T error_sum;  // sum of error in nominal steps
+  T derror;     // error derivative per nominal step, filtered
+
+  /*
+  * Coefficients
+  */
+  T Kp;  // Proprotional control coefficient
+  T Ki;  // Integral control coefficient
+  T Kd;  // Derivative control coefficient
+
+  T nominal_dt;  // the delta time the coefficients are tuned for
+  T tau;         // time constant of the derivative filter, 0 for no filtering
+  T windup;      // the limit of the absolute integral, 0 for no limit
+
+ public:
+  /*
+  * Constructor
+  * @param nominal_dt the delta time the coefficients are tuned for
+  */
+  constexpr TimedPIDController(T nominal_dt = 1): initial(true), target(0), error(0), error_sum(0), derror(0),
+    Kp(0), Ki(0), Kd(0), nominal_dt(nominal_dt), tau(0), windup(0) {}
+
+  /**
+   * Set the delta time the coefficients are tuned for
+   */
+  constexpr void setNominalDt(T value) { nominal_dt = value; }
+
+  /**
+   * Return the delta time the coefficients are tuned for
+   */
+  constexpr T getNominalDt() const { return nominal_dt; }
+
+  /**
+   * Set time constant of the derivative low pass filter
+   * @param value the time constant, 0 to disable the filter
+   */
+  constexpr void setDerivativeFilter(T value) { tau = value; }
+
+  /**
+   * Return the time constant of the derivative low pass filter
+   */
+  constexpr T getDerivativeFilter() const { return tau; }
+
+  /**
+   * Set the anti-windup limit of the integral
+   * @param value the maximal absolute sum of error, 0 for no limit
+   */
+  constexpr void setIntegralLimit(T value) { windup = value; }
+
+  /**
+   * Return the anti-windup limit of the integral
+   */
+  constexpr T getIntegralLimit() const { return windup; }
+
+  /**
+   * Set the control's target value
+   */
+  constexpr void setTarget(T value) { target = value; }
+
+  /**
+   * Return the control's target
+   */
+  constexpr T getTarget() const { return target; }
+
+  /*
+  * Initialize PID.
+  */
+  constexpr void init(T Kp, T Kd, T Ki) {
+    setPID(Kp, Kd, Ki);
+    error = 0;
+    error_sum = 0;
+    derror = 0;
+    initial = true;
+  }
+
+  /**
+   * Set the coefficients without re-initializing the PID
+   */
+  constexpr void setPID(T Kp, T Kd, T Ki) {
+    this->Kp = Kp;
+    this->Ki = Ki;
+    this->Kd = Kd;
+  }
+
+  /**
+   * Return current error
+   */
+  constexpr T getError() const { return error; }
+
+  /*
+  * Update the PID error variables given cross track error.
+  * @param value the error
+  * @param dt the delta time since the last update, the nominal delta time is used if it is not positive
+  */
+  constexpr void updateError(T value, T dt) {
+    if (!(dt > 0)) {
+      dt = nominal_dt;
+    }
+    if (initial) {
+      initial = false;
+      error = value;
+    }
+
+    T steps = dt / nominal_dt;
+    T d = (value - error) / steps;
+    if (tau > 0) {
+      derror += dt / (tau + dt) * (d - derror);
+    } else {
+      derror = d;
+    }
+    error_sum += value * steps;
+    if (windup > 0) {
+      if (error_sum > windup) error_sum = windup;
+      if (error_sum < -windup) error_sum = -windup;
+    }
+    error = value;
+  }
+
+  /*
+  * Calculate the PID control value to apply.
+  */
+  constexpr T getControl() const {
+    return -Kp * error - Kd * derror - Ki * error_sum;
+  }
+
+  /**
+   * Update the error, and return the control value to apply
+   * @param value the error
+   * @param dt the delta time since the last update
+   */
+  constexpr T update(T value, T dt) {
+    updateError(value, dt);
+    return getControl();
+  }
+
+  /**
+   * Update the value under control, and return the control value to apply
+   * @param value the value, the error is computed from the target
+   * @param dt the delta time since the last update
+   */
+  constexpr T updateValue(T value, T dt) {
+    return update(value - target, dt);
+  }
+};
+
+#endif
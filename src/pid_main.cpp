@@ -1,120 +1,26 @@
 #include <uWS/uWS.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <sstream>
+#include <thread>
 #include <math.h>
 #include "json.hpp"
-#include "control/PID.h"
-#include "utils/Reducer.h"
+#include "control/ControlParameters.h"
+#include "control/DriveEngine.h"
+#include "control/DriveSettings.h"
+#include "control/Messages.h"
+#include "utils/LogWriter.h"
+#include "utils/MathUtils.h"
+#include "utils/RcuPointer.h"
 
 // for convenience
 using json = nlohmann::json;
 
-// Maximal steering angle, +- 27 degree.
-static const double MAX_STEERING_ANGLE = 27 * M_PI / 180;
-
-
-#ifdef STABILIZE_MOTION
-#ifdef CLAMP_STEERING_DELTA
-// Maximal change in steering
-static const double MAX_STEERING_CHANGE = 0.5;
-#endif
-#ifdef USE_MEAN_TURN
-static const double CAR_LENGTH = 2.5;
-#endif
-#endif
-
-#ifdef USE_MOVING_AVERAGE
-// Weighted moving average of steering
-static double steering_weights[] = {1, 2, 3, 5, 7, 9, 11, 13};
-#endif
-
-// For converting back and forth between radians and degrees.
-
-double deg2rad(double x) { return x * M_PI / 180; }
-double rad2deg(double x) { return x * 180 / M_PI; }
-
-/**
- * Clamp a to min and max range
- * @param a the value to clamp
- * @param min the minimal value
- * @param max the maximal value
- * @retur the clampped value
- */
-template<typename T> T clamp(const T a, const T min, const T max) {
-  return a < min? min: (a > max? max: a);
-}
-
-// Checks if the SocketIO event has JSON data.
-// If there is data the JSON object in string format will be returned,
-// else the empty string "" will be returned.
-std::string hasData(std::string s) {
-  auto found_null = s.find("null");
-  auto b1 = s.find_first_of("[");
-  auto b2 = s.find_last_of("]");
-  if (found_null != std::string::npos) {
-    return "";
-  }
-  else if (b1 != std::string::npos && b2 != std::string::npos) {
-    return s.substr(b1, b2 - b1 + 1);
-  }
-  return "";
-}
-
-/**
- * Simple logic to adjust speed according to steering angle
- * @param angle the angle
- * @param max the maximal speed permitted
- */ 
-double computeSpeedTarget(double angle, double max) {
-  double y = fabs(angle);
-  if (y < 0.02) return max;
-  if (y < 0.075 ) return std::fmin(max,95);
-#ifdef STABILIZE_MOTION
-  if (y < 0.1 ) return std::fmin(max, 90);
-  if (y < 0.12 ) return std::fmin(max, 85);
-  if (y < 0.125 ) return std::fmin(max, 40);
-#elif defined(USE_MOVING_AVERAGE)
-  if (y < 0.0875 ) return std::fmin(max, 90);
-  if (y < 0.12 ) return std::fmin(max, 55);
-  if (y < 0.13 ) return std::fmin(max, 40);
-  if (y < 0.14) return std::fmin(max, 35);
-#else
-  if (y < 0.0875 ) return std::fmin(max, 90);
-  if (y < 0.12 ) return std::fmin(max, 85);
-  if (y < 0.13 ) return std::fmin(max, 60);
-  if (y < 0.14) return std::fmin(max, 35);
-#endif
-  if (y < 0.3 ) return std::fmin(max, 30);
-  if (y < 0.5 ) return std::fmin(max, 25);
-  return std::fmin(max, 20);
-}
-
-/**
- * Simple logic to compute throttle from acceleration.
- * @param accel the acceleration to reach
- * @param target the target speed
- * @param max_accel the maximal acceleration
- * @param max_decel the maximal deceleration
- */ 
-double computeThrottle(double accel, double target, double max_accel, double max_decel) {
-  // the throttle to keep if no accel, divide by 10 is a rough estimate of target speed,
-  // and throttle to keep for the speed
-  double keep = target / 10.0;
-  if (accel >= 0) { // acceleration
-    if (accel < 0.001) { // small acceleration, keep the mimimal throttle
-      return keep;
-    }
-    else { // otherwise compute the throttle
-      return std::fmin(1, keep + (1 - keep) * accel / max_accel); // max accel is 5
-    }
-  }
-  else {
-    if (accel <= -2) { // deceleration
-      return -1;
-    }
-
-    return -0.9 + (1 - 0.9) * accel / max_decel;
-  }
-}
+// seconds between flushes of the recorded telemetry
+#define RECORD_FLUSH_INTERVAL 1.0
 
 /**
  * define a function to return size of array, C++ compiler can infer the template
@@ -125,81 +31,92 @@ template<size_t SIZE, class T> inline size_t array_size(T (&arr)[SIZE]) {
   return SIZE;
 }
 
-int main(int argc, char* argv[])
-{
-  uWS::Hub h;
-
-#ifdef STABILIZE_MOTION
-  double s_coeffs[3] = {0.13, 4, 0};
-#elif defined(USE_MOVING_AVERAGE)
-  double s_coeffs[3] = {0.075, 2.5, 0};
-#else
-  double s_coeffs[3] = {0.108, 3.52, 0}; // {0.119058, 3.23448, 0};
-#endif
-
-  double v_coeffs[3] = {13.5795, -11.4359, 0};
+/**
+ * Settings of the controller given on the command line
+ */
+struct Settings {
+  DriveSettings drive;  // the settings of the driving pipeline
+  bool create_csv;      // write csv lines to stderr
+  std::string record_file; // the telemetry log to record to, empty to not record
+};
 
-  double max_speed = 100;
-  double max_accel = 8;
-  double max_decel = -20;
-  bool create_csv = false;
+/**
+ * Read a whole file
+ * @param path the file path
+ * @param text receives the content of the file
+ * @return true if successful
+ */
+bool readFile(const std::string &path, std::string &text) {
+  std::ifstream in(path.c_str());
+  if (!in) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << in.rdbuf();
+  text = buffer.str();
+  return true;
+}
 
-  // Process command line options
-  for (int i = 1; i < argc; i++) {
-    if (std::string((argv[i])) == "-s") { // steering PID coefficients
-      if (sscanf(argv[++i], "%lf", &s_coeffs[0]) != 1) {
-        std::cerr << "Invalid yaw PID coefficient: " << argv[i] << std::endl;
-        exit(-1);
-      }
-      if (sscanf(argv[++i], "%lf", &s_coeffs[1]) != 1) {
-        std::cerr << "Invalid yaw PID coefficient: " << argv[i] << std::endl;
-        exit(-1);
-      }
-      if (sscanf(argv[++i], "%lf", &s_coeffs[2]) != 1) {
-        std::cerr << "Invalid yaw PID coefficient: " << argv[i] << std::endl;
-        exit(-1);
-      }
-    } else if (std::string((argv[i])) == "-v") { // vecocity coefficient
-      if (sscanf(argv[++i], "%lf", &v_coeffs[0]) != 1) {
-        std::cerr << "Invalid veclocity PID coefficient: " << argv[i] << std::endl;
-        exit(-1);
-      }
-      if (sscanf(argv[++i], "%lf", &v_coeffs[1]) != 1) {
-        std::cerr << "Invalid veclocity PID coefficient: " << argv[i] << std::endl;
-        exit(-1);
-      }
-      if (sscanf(argv[++i], "%lf", &v_coeffs[2]) != 1) {
-        std::cerr << "Invalid veclocity PID coefficient: " << argv[i] << std::endl;
-        exit(-1);
-      }
-    } else if (std::string((argv[i])) == "-max_speed") { // maximum speed
-      if (sscanf(argv[++i], "%lf", &max_speed) != 1) {
-        std::cerr << "Invalid y: " << argv[i] << std::endl;
-        exit(-1);
+/**
+ * Watch a parameter file, and publish the parameters whenever it is modified. This runs on its own
+ * thread, and polls the modification time of the file, as the file may be replaced by editors
+ * @param path the parameter file
+ * @param parameters the parameters to publish to
+ */
+void watchParameters(const std::string path, RcuPointer<ControlParameters> *parameters) {
+  time_t modified = 0;
+  off_t size = -1;
+  while (true) {
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0 && (st.st_mtime != modified || st.st_size != size)) {
+      modified = st.st_mtime;
+      size = st.st_size;
+      std::string text, error;
+      if (!readFile(path, text)) {
+        std::cerr << "Failed to read parameters: " << path << std::endl;
+      } else if (parameters->update([&text, &error](ControlParameters &p) { return p.update(text, error); })) {
+        std::cout << "Parameters reloaded: " << text << std::endl;
+      } else {
+        std::cerr << "Invalid parameters in " << path << ": " << error << std::endl;
       }
-    } else if (std::string((argv[i])) == "-csv") { // maximum speed
-      create_csv = true;
     }
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
   }
+}
 
-  // PID controller for steering
-  PID pid_steering;
-  pid_steering.init(s_coeffs[0], s_coeffs[1], s_coeffs[2]);
-
-  // PID controller for acceleration
-  PID pid_accel;
-  pid_accel.init(v_coeffs[0], v_coeffs[1], v_coeffs[2]); 
-
-  // Use the mean of past 5 readings to determine the speed of the vehicle
-  Reducer<double> angleReducer(5);
+/**
+ * Drive the car connected to the hub with the given steering pipeline. The pipeline is a template
+ * parameter, so that every combination of steering stages gets its own message handler without
+ * checking the disabled stages on every message.
+ * The coefficients and tuning parameters are read from the published snapshot on every message, so
+ * they can be changed without restarting, and without losing the states of the PIDs and reducers.
+ * @param h the hub
+ * @param settings the settings
+ * @param parameters the published coefficients and tuning parameters
+ */
+template<class Steering> void drive(uWS::Hub &h, const Settings &settings, RcuPointer<ControlParameters> *parameters) {
+  // The driving pipeline
+  DriveEngine<Steering> engine(settings.drive);
+
+  // Time of the first telemetry message
+  std::chrono::steady_clock::time_point start_time;
+
+  // The recorded telemetry log, shared by the copies of the handler
+  std::shared_ptr<LogWriter<Telemetry> > recorder;
+  if (!settings.record_file.empty()) {
+    recorder = std::make_shared<LogWriter<Telemetry> >();
+    if (!recorder->open(settings.record_file)) {
+      std::cerr << "Failed to create telemetry log: " << settings.record_file << std::endl;
+      exit(-1);
+    }
+  }
 
-  // Use the mean of past 40 readings to determine the curverature
-  Reducer<double> stabilizeReducer(30);
-  Reducer<double> speedReducer(30);
-  Reducer<double> steerReducer(5);
+  bool create_csv = settings.create_csv;
+  // time of the last flush of the recorded telemetry
+  double flush_time = 0;
 
-  h.onMessage([&pid_steering, &pid_accel, &angleReducer, &steerReducer, &stabilizeReducer, &speedReducer, max_speed, max_accel, max_decel, create_csv]
-    (uWS::WebSocket<uWS::SERVER> ws, char *data, size_t length, uWS::OpCode opCode) {
+  h.onMessage([engine, start_time, recorder, flush_time, parameters, create_csv]
+    (uWS::WebSocket<uWS::SERVER> ws, char *data, size_t length, uWS::OpCode opCode) mutable {
     // "42" at the start of the message means there's a websocket message event.
     // The 4 signifies a websocket message
     // The 2 signifies a websocket event
@@ -208,106 +125,36 @@ int main(int argc, char* argv[])
       auto s = hasData(std::string(data).substr(0, length));
       if (s != "") {
         auto j = json::parse(s);
-        std::string event = j[0].get<std::string>();
-        if (event == "telemetry") {
-          // j[1] is the data JSON object
-          double cte = std::stod(j[1]["cte"].get<std::string>()); 
-          double speed = std::stod(j[1]["speed"].get<std::string>());
-          // what is the steering angle from the simulator? and the unit, is it the yaw instead?
-          // As it is very off from values sent to the simulator 
-          double angle = std::stod(j[1]["steering_angle"].get<std::string>()); 
-          std::cout << "steering_angle: " << angle << std::endl;
-          // UPdate the steering PID error
-          pid_steering.updateError(cte);
-          // Get the PID control value, it needs to be be normalized it to [-1, 1] range
-          double steer_value = clamp(pid_steering.getControl() / MAX_STEERING_ANGLE, -1.0, 1.0);
-
-          // Add the angle to the reducer
-          angleReducer.push(fabs(angle));
-
-#ifdef STABILIZE_MOTION
-          // Apply a low pass filter once we have enough samples
-#ifdef CLAMP_STEERING_DELTA
-          if (steerReducer.size() > 0) {
-            double delta = steer_value - steerReducer[steerReducer.size() - 1];
-            if (fabs(delta) > MAX_STEERING_CHANGE) { // too much change, clamp it
-              steer_value = steerReducer[steerReducer.size() - 1] + delta < 0? -MAX_STEERING_CHANGE: MAX_STEERING_CHANGE;
-            }
+        Telemetry t;
+        if (parseTelemetry(j, t)) {
+          std::cout << "steering_angle: " << t.angle << std::endl;
+          // Time the message with the monotonic clock
+          std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+          if (start_time.time_since_epoch().count() == 0) {
+            start_time = now;
           }
-#endif
-          steerReducer.push(steer_value);
-          double radian = deg2rad(angle);
-#ifdef USE_MEAN_TURN
-          // Compute turing angle from steering angle
-          double turn = tan(radian) * speed / CAR_LENGTH;
-          stabilizeReducer.push(turn);
-          speedReducer.push(speed);
-#else
-          // Add the angle to the reducer
-          stabilizeReducer.push(radian);
-#endif
-          if (stabilizeReducer.getNumberOfSamplesReceived() >= 200) { // we have enough samples to begin with
-            // Get the average steering value and clamp to [-1, 1]
-            steer_value = steerReducer.mean<double>(steering_weights);
-            steer_value = clamp(steer_value, -1.0, 1.0);
-#ifdef USE_MEAN_TURN
-            // Stabilize with the average turn, use it and the average speed to compute the steering offset
-            double turn = stabilizeReducer.mean<double>();
-            turn *= CAR_LENGTH/speedReducer.mean<double>();
-            double steer_offset = -atan(turn) / MAX_STEERING_ANGLE;
-#else
-            // Regularize steering with moving angle average to reduce oscillation caused by overshots
-            double steer_offset = -stabilizeReducer.mean<double>() / MAX_STEERING_ANGLE;
-#endif
-            steer_value += steer_offset;
-            // Clamp steering value to [-1, 1] range
-            steer_value = clamp(steer_value, -1.0, 1.0);
-            if (create_csv) {
-              std::cerr << steer_offset << "," << steer_value << "," << deg2rad(angle) << "," << cte << "," << speed 
-                        << "," << steerReducer[steerReducer.size() - 1] << std::endl;
+          t.time = std::chrono::duration<double>(now - start_time).count();
+          if (recorder) {
+            // the records are buffered, and flushed once a second, so a crash loses at most the
+            // last second of them
+            recorder->append(t);
+            if (t.time - flush_time >= RECORD_FLUSH_INTERVAL) {
+              recorder->flush();
+              flush_time = t.time;
             }
           }
-#else
-#ifdef USE_MOVING_AVERAGE
-          steerReducer.push(steer_value);
-          if (steerReducer.getNumberOfSamplesReceived() >= steerReducer.getLimit()) {
-            steer_value = steerReducer.mean<double>(steering_weights);
-            steer_value = clamp(steer_value, -1.0, 1.0);
-          }
-#endif
-        if (create_csv) {
-          std::cerr << steer_value << "," << deg2rad(angle) << "," << cte << "," << speed  << std::endl;
-        }
-#endif // #else
-          // Get the average of the past angle readings
-          double reduced_angle = angleReducer.mean<double>();
 
-          // Determing the speed from the mean angle
-          double targetSpeed = computeSpeedTarget(deg2rad(reduced_angle), max_speed);
-          // The scceleration or deceleration
-          double speed_adjustment = targetSpeed - speed;
-          // Update the acceleration PID error
-          pid_accel.updateError(-speed_adjustment);
-          // Compute the acceleration/deceleration, 1 second to reach the target
-          double accelDecel = pid_accel.getControl() / 1.0;
-
-          // Clamp the acceleration to [max_decel, max_accel]
-          if (accelDecel > max_accel) {
-            accelDecel =  max_accel;
-          }
-          else if (accelDecel < max_decel) {
-            accelDecel = max_decel;
+          // Compute the controls with the latest published parameters, they stay valid until
+          // quiescent() is called
+          DriveControl control = engine.update(t, *parameters->read());
+          if (create_csv) {
+            engine.getSteering().csv(std::cerr, control.steering, t.angle, t.cte, t.speed);
           }
-
-          double throttle = computeThrottle(accelDecel, targetSpeed, max_accel, max_decel);
           // DEBUG
-          std::cout << "CTE: " << cte << " Steering Value: " << steer_value << " current: " << angle << "(" << deg2rad(angle) << ","
-                    << reduced_angle << ")" << std::endl;
-          std::cout << "Speed adjustment: " << speed_adjustment << ", current: " << speed << ", accel: " << accelDecel << std::endl;
-          json msgJson;
-          msgJson["steering_angle"] = steer_value;
-          msgJson["throttle"] = throttle;
-          auto msg = "42[\"steer\"," + msgJson.dump() + "]";
+          std::cout << "CTE: " << t.cte << " Steering Value: " << control.steering << " current: " << t.angle << "(" << deg2rad(t.angle) << ","
+                    << control.reduced_angle << ")" << std::endl;
+          std::cout << "Speed adjustment: " << control.target_speed - t.speed << ", current: " << t.speed << ", accel: " << control.accel << std::endl;
+          auto msg = steerMessage(control.steering, control.throttle);
           std::cout << msg << std::endl;
           ws.send(msg.data(), msg.length(), uWS::OpCode::TEXT);
         }
@@ -317,13 +164,69 @@ int main(int argc, char* argv[])
         ws.send(msg.data(), msg.length(), uWS::OpCode::TEXT);
       }
     }
+    // Done with the parameters of this cycle
+    parameters->quiescent();
+  });
+}
+
+int main(int argc, char* argv[])
+{
+  uWS::Hub h;
+
+  Settings settings;
+  settings.create_csv = false;
+  settings.record_file = "";
+  std::string watch_file = ""; // the parameter file to watch
+
+  // Process command line options
+  for (int i = 1; i < argc; i++) {
+    if (settings.drive.parseOption(argv, i)) {
+      continue;
+    } else if (std::string((argv[i])) == "-csv") { // write csv lines
+      settings.create_csv = true;
+    } else if (std::string((argv[i])) == "-watch") { // parameter file to watch
+      watch_file = argv[++i];
+    } else if (std::string((argv[i])) == "-record") { // telemetry log to record to
+      settings.record_file = argv[++i];
+    }
+  }
+  settings.drive.finish();
+
+  // The coefficients and tuning parameters published to the message handler
+  RcuPointer<ControlParameters> parameters(new ControlParameters(settings.drive.params));
+  if (!watch_file.empty()) {
+    std::thread(watchParameters, watch_file, &parameters).detach();
+  }
+
+  // Select the message handler for the steering stages
+  settings.drive.withSteering([&](auto steering) {
+    drive<decltype(steering)>(h, settings, &parameters);
   });
 
-  // We don't need this since we're not using HTTP but if it's removed the program
-  // doesn't compile :-(
-  h.onHttpRequest([](uWS::HttpResponse *res, uWS::HttpRequest req, char *data, size_t, size_t) {
+  // Parameters can be read with GET /parameters, and changed with POST /parameters with a JSON object
+  // in the body, see ControlParameters for the format
+  h.onHttpRequest([&parameters](uWS::HttpResponse *res, uWS::HttpRequest req, char *data, size_t length, size_t remaining) {
     const std::string s = "<h1>Hello world!</h1>";
-    if (req.getUrl().valueLength == 1)
+    std::string url = req.getUrl().toString();
+    if (url == "/parameters") {
+      std::string response;
+      if (req.getMethod() == uWS::HttpMethod::METHOD_POST) {
+        std::string text(data? data: "", data? length: 0), error;
+        if (remaining > 0) {
+          response = "{\"error\": \"parameters are too large\"}";
+        } else if (parameters.update([&text, &error](ControlParameters &p) { return p.update(text, error); })) {
+          std::cout << "Parameters updated: " << text << std::endl;
+          response = "{\"ok\": true}";
+        } else {
+          response = json({{"error", error}}).dump();
+        }
+      } else {
+        // the requests are handled on the same thread as the messages, so it may read the snapshot
+        response = parameters.read()->toJson();
+      }
+      res->end(response.data(), response.length());
+    }
+    else if (req.getUrl().valueLength == 1)
     {
       res->end(s.data(), s.length());
     }
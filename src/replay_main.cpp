@@ -0,0 +1,193 @@
+#include <math.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "control/DriveEngine.h"
+#include "control/DriveSettings.h"
+#include "utils/LogWriter.h"
+#include "utils/MappedLog.h"
+#include "utils/ThreadPool.h"
+
+/**
+ * Result of replaying a telemetry log
+ */
+struct ReplayResult {
+  std::string error;   // the error, empty if the replay succeeded
+  size_t messages;     // number of messages replayed
+  double seconds;      // time taken by the pipeline
+  size_t mismatches;   // number of controls that differ from the reference beyond the tolerance
+  double max_steering_diff; // maximal absolute difference of steering from the reference
+  double max_throttle_diff; // maximal absolute difference of throttle from the reference
+};
+
+/**
+ * Return the file name of a path without the directories
+ */
+std::string baseName(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  return slash == std::string::npos? path: path.substr(slash + 1);
+}
+
+/**
+ * Replay a telemetry log through the driving pipeline with the given steering stages
+ * @param settings the settings of the pipeline
+ * @param path the telemetry log
+ * @param save_dir the directory to save the controls to, empty to not save them
+ * @param compare_dir the directory of the reference controls, empty to not compare
+ * @param tolerance the maximal absolute difference of the controls from the reference
+ * @param result receives the result
+ */
+template<class Steering> void replay(const DriveSettings &settings, const std::string &path,
+    const std::string &save_dir, const std::string &compare_dir, double tolerance, ReplayResult &result) {
+  MappedLog<Telemetry> log;
+  if (!log.open(path)) {
+    result.error = "not a telemetry log";
+    return;
+  }
+  std::vector<DriveControl> controls(log.size());
+  DriveEngine<Steering> engine(settings);
+
+  // Only the pipeline is timed, the messages are read in place from the mapped file
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  const Telemetry *messages = log.data();
+  for (size_t i = 0; i < log.size(); i++) {
+    controls[i] = engine.update(messages[i], settings.params);
+  }
+  std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+  result.messages = log.size();
+  result.seconds = std::chrono::duration<double>(end - start).count();
+
+  std::string name = baseName(path) + ".ctl";
+  if (!save_dir.empty()) {
+    LogWriter<DriveControl> writer;
+    bool ok = writer.open(save_dir + "/" + name);
+    for (size_t i = 0; ok && i < controls.size(); i++) {
+      ok = writer.append(controls[i]);
+    }
+    if (!writer.close() || !ok) {
+      result.error = "failed to save the controls";
+      return;
+    }
+  }
+  if (!compare_dir.empty()) {
+    MappedLog<DriveControl> reference;
+    if (!reference.open(compare_dir + "/" + name)) {
+      result.error = "no reference controls";
+      return;
+    }
+    size_t n = std::min(reference.size(), controls.size());
+    // the missing or extra controls are all mismatches
+    result.mismatches = std::max(reference.size(), controls.size()) - n;
+    for (size_t i = 0; i < n; i++) {
+      double steering_diff = fabs(controls[i].steering - reference[i].steering);
+      double throttle_diff = fabs(controls[i].throttle - reference[i].throttle);
+      // NaN differences are mismatches too
+      if (!(steering_diff <= tolerance && throttle_diff <= tolerance)) {
+        result.mismatches++;
+      }
+      result.max_steering_diff = std::fmax(result.max_steering_diff, steering_diff);
+      result.max_throttle_diff = std::fmax(result.max_throttle_diff, throttle_diff);
+    }
+  }
+}
+
+int main(int argc, char* argv[]) {
+  DriveSettings settings;
+  int threads = 0; // number of threads, 0 for the number of hardware threads
+  std::string save_dir = ""; // directory to save the controls to
+  std::string compare_dir = ""; // directory of the reference controls
+  double tolerance = 0; // tolerance of the differences from the reference controls
+  std::vector<std::string> files; // the telemetry logs
+
+  // Process command line options
+  for (int i = 1; i < argc; i++) {
+    if (settings.parseOption(argv, i)) {
+      continue;
+    } else if (std::string((argv[i])) == "-threads") { // number of threads
+      if (sscanf(argv[++i], "%d", &threads) != 1 || threads < 0) {
+        std::cerr << "Invalid threads: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-save") { // directory to save the controls to
+      save_dir = argv[++i];
+    } else if (std::string((argv[i])) == "-compare") { // directory of the reference controls
+      compare_dir = argv[++i];
+    } else if (std::string((argv[i])) == "-tolerance") { // tolerance of the differences
+      if (sscanf(argv[++i], "%lf", &tolerance) != 1 || tolerance < 0) {
+        std::cerr << "Invalid tolerance: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (argv[i][0] == '-') {
+      std::cerr << "Unknown option: " << argv[i] << std::endl;
+      exit(-1);
+    } else {
+      files.push_back(argv[i]);
+    }
+  }
+  settings.finish();
+  if (files.empty()) {
+    std::cerr << "No telemetry log is given" << std::endl;
+    exit(-1);
+  }
+  // the controls of a log are saved and compared by the file name of the log, which must be unique
+  if (!save_dir.empty() || !compare_dir.empty()) {
+    std::set<std::string> names;
+    for (size_t i = 0; i < files.size(); i++) {
+      if (!names.insert(baseName(files[i])).second) {
+        std::cerr << "Logs with the same file name map to the same controls: " << baseName(files[i]) << std::endl;
+        exit(-1);
+      }
+    }
+  }
+
+  // Replay the logs in parallel, every log has its own pipeline
+  std::vector<ReplayResult> results(files.size(), ReplayResult{"", 0, 0, 0, 0, 0});
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  {
+    ThreadPool pool(threads);
+    for (size_t i = 0; i < files.size(); i++) {
+      pool.submit([&settings, &files, &results, &save_dir, &compare_dir, tolerance, i]() {
+        settings.withSteering([&](auto steering) {
+          replay<decltype(steering)>(settings, files[i], save_dir, compare_dir, tolerance, results[i]);
+        });
+      });
+    }
+    pool.wait();
+  }
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Report the results
+  size_t total = 0, failures = 0;
+  std::cout << std::left << std::setw(40) << "Log" << std::right << std::setw(12) << "Messages"
+            << std::setw(16) << "Messages/s";
+  if (!compare_dir.empty()) {
+    std::cout << std::setw(12) << "Mismatches" << std::setw(16) << "Max steering" << std::setw(16) << "Max throttle";
+  }
+  std::cout << std::endl;
+  for (size_t i = 0; i < files.size(); i++) {
+    const ReplayResult &result = results[i];
+    std::cout << std::left << std::setw(40) << files[i] << std::right;
+    if (!result.error.empty()) {
+      std::cout << " " << result.error << std::endl;
+      failures++;
+      continue;
+    }
+    total += result.messages;
+    std::cout << std::setw(12) << result.messages << std::setw(16) << std::fixed << std::setprecision(0)
+              << (result.seconds > 0? result.messages / result.seconds: 0);
+    if (!compare_dir.empty()) {
+      std::cout << std::setw(12) << result.mismatches << std::setprecision(6) << std::scientific
+                << std::setw(16) << result.max_steering_diff << std::setw(16) << result.max_throttle_diff;
+      if (result.mismatches > 0) {
+        failures++;
+      }
+    }
+    std::cout << std::endl;
+  }
+  std::cout << "Total: " << total << " messages in " << std::fixed << std::setprecision(3) << wall
+            << " seconds, " << std::setprecision(0) << (wall > 0? total / wall: 0) << " messages/s" << std::endl;
+  return failures > 0? 1: 0;
+}
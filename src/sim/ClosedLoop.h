@@ -0,0 +1,153 @@
+#ifndef _SIM_CLOSEDLOOP_H_
+#define _SIM_CLOSEDLOOP_H_
+
+#include <math.h>
+#include "Track.h"
+#include "Vehicle.h"
+#include "../control/DriveEngine.h"
+#include "../control/DriveSettings.h"
+#include "../utils/MathUtils.h"
+#include "../utils/NormalGenerator.h"
+
+using namespace std;
+
+/**
+ * Options of a closed loop lap
+ */
+struct LapOptions {
+  double dt = 0.05;          // interval between telemetry messages
+  double half_width = 4;     // the car is off the track when the absolute CTE exceeds it
+  double max_time = 300;     // the lap fails if it is not completed in time
+  double noise[2] = {0, 0};  // standard deviations of the acceleration and steering angle noise
+  double length = 2.5;       // length of the car
+};
+
+/**
+ * Scores of a closed loop lap
+ */
+struct LapResult {
+  bool completed;     // true if the lap is completed without leaving the track
+  double time;        // lap time, or the time when the car left the track
+  double max_cte;     // maximal absolute CTE
+  double rms_cte;     // root mean square of CTE
+  double smoothness;  // root mean square of the change of the steering value per message
+  double mean_speed;  // mean speed in mph
+  int steps;          // number of telemetry messages
+};
+
+/**
+ * ClosedLoop drives the kinematic car model around a track with the driving pipeline, so that
+ * changes to the pipeline can be judged for speed and safety without the simulator. On every
+ * step the CTE and speed of the car are sent to the pipeline as a telemetry message, with the
+ * speed in mph like the simulator, and the car is moved with the steering and throttle it returns.
+ * The simulator steers right for positive steering values, and the car model turns left for
+ * positive angles, so the steering is negated. The throttle is turned into acceleration with a
+ * simple power train: full throttle accelerates at the maximal acceleration at standstill against
+ * a drag that balances it at the top speed, and negative throttle brakes.
+ * The noise is drawn in blocks from a NormalGenerator seeded with the seed of the lap.
+ */
+template<class Steering> class ClosedLoop {
+public:
+  // acceleration at full throttle
+  static constexpr double POWER = 8;
+  // deceleration at full brake
+  static constexpr double BRAKE = 20;
+  // speed at full throttle in mph
+  static constexpr double TOP_SPEED = 100;
+  // meters per second in a mph, the car model moves in meters and the pipeline expects mph
+  static constexpr double MPH = 1.61 * 1000 / 3600;
+
+private:
+  const DriveSettings &settings;
+  const Track &track;
+  LapOptions options;
+
+public:
+  /**
+   * Constructor
+   * @param settings settings of the driving pipeline
+   * @param track the track, the car starts at its first point
+   * @param options the lap options
+   */
+  ClosedLoop(const DriveSettings &settings, const Track &track, const LapOptions &options):
+    settings(settings), track(track), options(options) {}
+
+  /**
+   * Return the acceleration of a throttle
+   * @param throttle the throttle
+   * @param speed the current speed in mph
+   */
+  static double acceleration(double throttle, double speed) {
+    throttle = clamp(throttle, -1.0, 1.0);
+    double drag = POWER * speed / TOP_SPEED;
+    return throttle >= 0? POWER * throttle - drag: BRAKE * throttle - drag;
+  }
+
+  /**
+   * Drive a lap
+   * @param seed seed of the noise
+   * @return the scores of the lap
+   */
+  LapResult run(unsigned seed) const {
+    NormalGenerator noise(seed);
+
+    DriveEngine<Steering> engine(settings);
+    Vehicle car(options.length, track.getX(0), track.getY(0), track.getHeading(0), 0);
+    car.setLimits(MAX_STEERING_ANGLE, POWER, -BRAKE, TOP_SPEED * MPH);
+
+    LapResult result = {false, 0, 0, 0, 0, 0, 0};
+    double length = track.getLength();
+    double last_distance = 0, progress = 0;
+    double steering = 0;
+    int hint = -1;
+    double cte_sum = 0, change_sum = 0, speed_sum = 0;
+    Telemetry t;
+    while (result.time < options.max_time) {
+      TrackPosition position = track.locate(car.getX(), car.getY(), hint);
+      // the distance travelled along the track, wrapped at the start line
+      double delta = position.distance - last_distance;
+      if (delta < -length / 2) delta += length;
+      if (delta > length / 2) delta -= length;
+      progress += delta;
+      last_distance = position.distance;
+      if (progress >= length) {
+        result.completed = true;
+        break;
+      }
+      result.max_cte = fmax(result.max_cte, fabs(position.cte));
+      if (fabs(position.cte) > options.half_width) {
+        break;
+      }
+
+      t.time = result.time;
+      t.cte = position.cte;
+      t.speed = car.getVelocity() / MPH;
+      t.angle = rad2deg(steering * MAX_STEERING_ANGLE);
+      DriveControl control = engine.update(t, settings.params);
+
+      double change = control.steering - steering;
+      steering = control.steering;
+      cte_sum += position.cte * position.cte;
+      change_sum += change * change;
+      speed_sum += t.speed;
+      result.steps++;
+
+      double accel = acceleration(control.throttle, t.speed) + (options.noise[0] > 0? noise(options.noise[0]): 0);
+      double angle = -steering * MAX_STEERING_ANGLE + (options.noise[1] > 0? noise(options.noise[1]): 0);
+      car.move(options.dt, angle, accel);
+      if (car.getVelocity() < 0) {
+        // brakes do not reverse the car
+        car.setVelocity(0);
+      }
+      result.time += options.dt;
+    }
+    if (result.steps > 0) {
+      result.rms_cte = sqrt(cte_sum / result.steps);
+      result.smoothness = sqrt(change_sum / result.steps);
+      result.mean_speed = speed_sum / result.steps;
+    }
+    return result;
+  }
+};
+
+#endif
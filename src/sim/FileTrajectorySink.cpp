@@ -0,0 +1,29 @@
+#include "FileTrajectorySink.h"
+
+FileTrajectorySink::FileTrajectorySink(): count(0), ok(false) {
+  block.reserve(BLOCK);
+}
+
+bool FileTrajectorySink::open(const string &path) {
+  close();
+  count = 0;
+  ok = writer.open(path);
+  return ok;
+}
+
+void FileTrajectorySink::writeBlock() {
+  if (writer.isOpen() && !writer.append(block.data(), block.size())) {
+    ok = false;
+  }
+  block.clear();
+}
+
+bool FileTrajectorySink::close() {
+  if (!writer.isOpen()) {
+    block.clear();
+    return ok;
+  }
+  writeBlock();
+  ok = writer.close() && ok;
+  return ok;
+}
@@ -0,0 +1,68 @@
+#ifndef _SIM_FILETRAJECTORYSINK_H_
+#define _SIM_FILETRAJECTORYSINK_H_
+
+#include <string>
+#include <vector>
+#include "TrajectorySink.h"
+#include "../utils/LogWriter.h"
+
+using namespace std;
+
+/**
+ * FileTrajectorySink streams the trajectory to a log of TrajectoryPoint records, which can be
+ * read by MappedLog. The points are collected in a block of fixed size, which is written with a
+ * single write when it is full, so a trajectory of any length is recorded in constant memory.
+ */
+class FileTrajectorySink: public TrajectorySink {
+public:
+  // number of points in a block
+  static const size_t BLOCK = 16384;
+
+private:
+  // the log file
+  LogWriter<TrajectoryPoint> writer;
+  // the points not yet written
+  vector<TrajectoryPoint> block;
+  // number of points written or collected since the log was opened
+  size_t count;
+  // false if a block failed to be written
+  bool ok;
+
+  /**
+   * Write the collected points
+   */
+  void writeBlock();
+
+public:
+  FileTrajectorySink();
+
+  ~FileTrajectorySink() { close(); }
+
+  /**
+   * Create the log file, an existing file is overwritten
+   * @param path the file path
+   * @return true if successful
+   */
+  bool open(const string &path);
+
+  void record(const TrajectoryPoint &point) {
+    block.push_back(point);
+    count++;
+    if (block.size() == BLOCK) {
+      writeBlock();
+    }
+  }
+
+  /**
+   * Return the number of points recorded since the log was opened
+   */
+  size_t size() const { return count; }
+
+  /**
+   * Write the collected points and close the log
+   * @return true if all the points were written
+   */
+  bool close();
+};
+
+#endif
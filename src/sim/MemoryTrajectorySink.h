@@ -0,0 +1,76 @@
+#ifndef _SIM_MEMORYTRAJECTORYSINK_H_
+#define _SIM_MEMORYTRAJECTORYSINK_H_
+
+#include <algorithm>
+#include <vector>
+#include "TrajectorySink.h"
+
+using namespace std;
+
+/**
+ * MemoryTrajectorySink keeps the trajectory in memory. Room for the points of a run is reserved
+ * before the run, so recording a step never reallocates. The room at least doubles when it grows,
+ * so the runs of a sweep recorded one after another are not copied again on every run.
+ */
+class MemoryTrajectorySink: public TrajectorySink {
+  // the recorded points
+  vector<TrajectoryPoint> points;
+
+public:
+  /**
+   * Constructor
+   * @param capacity number of points to reserve room for
+   */
+  explicit MemoryTrajectorySink(size_t capacity = 0) { points.reserve(capacity); }
+
+  void begin(size_t steps) {
+    if (points.size() + steps > points.capacity()) {
+      points.reserve(max(points.size() + steps, 2 * points.capacity()));
+    }
+  }
+
+  void record(const TrajectoryPoint &point) { points.push_back(point); }
+
+  /**
+   * Remove the recorded points, and keep the room for them
+   */
+  void clear() { points.clear(); }
+
+  /**
+   * Return the recorded points, and leave the sink empty
+   */
+  vector<TrajectoryPoint> release() {
+    vector<TrajectoryPoint> released;
+    released.swap(points);
+    return released;
+  }
+
+  /**
+   * Return the recorded points
+   */
+  const vector<TrajectoryPoint> &getPoints() const { return points; }
+
+  /**
+   * Return the x coordinates of the recorded points
+   */
+  vector<double> getX() const {
+    vector<double> x(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+      x[i] = points[i].x;
+    }
+    return x;
+  }
+
+  /**
+   * Return the y coordinates of the recorded points
+   */
+  vector<double> getY() const {
+    vector<double> y(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+      y[i] = points[i].y;
+    }
+    return y;
+  }
+};
+
+#endif
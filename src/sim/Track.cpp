@@ -0,0 +1,355 @@
+#include <algorithm>
+#include <cstdlib>
+#include <math.h>
+#include <fstream>
+#include <sstream>
+#include "Track.h"
+
+Track::Track() {}
+
+Track::Track(const vector<double> &xs, const vector<double> &ys): xs(xs), ys(ys) {
+  if (xs.size() != ys.size()) {
+    throw "The number of x and y coordinates differ";
+  }
+  if (xs.size() < 3) {
+    throw "A track needs at least 3 points";
+  }
+  build();
+}
+
+void Track::build() {
+  int n = size();
+  distances.resize(n + 1);
+  curvatures.resize(n);
+  distances[0] = 0;
+  for (int i = 0; i < n; i++) {
+    int next = (i + 1) % n;
+    double length = hypot(xs[next] - xs[i], ys[next] - ys[i]);
+    if (length <= 0) {
+      throw "The track has duplicate points";
+    }
+    distances[i + 1] = distances[i] + length;
+  }
+  // Menger curvature of every point and its neighbours, 4 * area / product of the sides
+  for (int i = 0; i < n; i++) {
+    int prev = (i + n - 1) % n;
+    int next = (i + 1) % n;
+    double ax = xs[i] - xs[prev], ay = ys[i] - ys[prev];
+    double bx = xs[next] - xs[i], by = ys[next] - ys[i];
+    double cross = ax * by - ay * bx;
+    double sides = hypot(ax, ay) * hypot(bx, by) * hypot(xs[next] - xs[prev], ys[next] - ys[prev]);
+    curvatures[i] = sides > 0? 2 * cross / sides: 0;
+  }
+  nodes.clear();
+  nodes.reserve(4 * n / LEAF_SIZE + 1);
+  buildNode(0, n);
+  clearances.resize(n);
+  for (int i = 0; i < n; i++) {
+    clearances[i] = clearance(i);
+  }
+}
+
+int Track::buildNode(int first, int count) {
+  int index = (int)nodes.size();
+  nodes.push_back(Node());
+  Node node;
+  node.first = first;
+  node.count = count;
+  node.min_x = node.min_y = INFINITY;
+  node.max_x = node.max_y = -INFINITY;
+  for (int i = first; i <= first + count; i++) {
+    // the segment i ends at point i + 1
+    int p = i % size();
+    node.min_x = fmin(node.min_x, xs[p]);
+    node.max_x = fmax(node.max_x, xs[p]);
+    node.min_y = fmin(node.min_y, ys[p]);
+    node.max_y = fmax(node.max_y, ys[p]);
+  }
+  if (count <= LEAF_SIZE) {
+    node.left = node.right = -1;
+  } else {
+    node.left = buildNode(first, count / 2);
+    node.right = buildNode(first + count / 2, count - count / 2);
+  }
+  nodes[index] = node;
+  return index;
+}
+
+Track Track::oval(double straight, double radius, double spacing) {
+  vector<double> xs, ys;
+  int straight_points = (int)ceil(straight / spacing);
+  int arc_points = (int)ceil(M_PI * radius / spacing);
+  // bottom straight heading east, the left turn, the top straight heading west, and the left turn
+  for (int i = 0; i < straight_points; i++) {
+    xs.push_back(straight * i / straight_points);
+    ys.push_back(-radius);
+  }
+  for (int i = 0; i < arc_points; i++) {
+    double a = -M_PI / 2 + M_PI * i / arc_points;
+    xs.push_back(straight + radius * cos(a));
+    ys.push_back(radius * sin(a));
+  }
+  for (int i = 0; i < straight_points; i++) {
+    xs.push_back(straight - straight * i / straight_points);
+    ys.push_back(radius);
+  }
+  for (int i = 0; i < arc_points; i++) {
+    double a = M_PI / 2 + M_PI * i / arc_points;
+    xs.push_back(radius * cos(a));
+    ys.push_back(radius * sin(a));
+  }
+  return Track(xs, ys);
+}
+
+Track Track::spline(int samples) const {
+  int n = size();
+  vector<double> sx, sy;
+  for (int i = 0; i < n; i++) {
+    // the curve from point i to point i + 1 is shaped by the points before and after them
+    int p0 = (i + n - 1) % n, p1 = i, p2 = (i + 1) % n, p3 = (i + 2) % n;
+    for (int k = 0; k < samples; k++) {
+      double t = (double)k / samples;
+      double t2 = t * t, t3 = t2 * t;
+      double w0 = -0.5 * t3 + t2 - 0.5 * t;
+      double w1 = 1.5 * t3 - 2.5 * t2 + 1;
+      double w2 = -1.5 * t3 + 2 * t2 + 0.5 * t;
+      double w3 = 0.5 * t3 - 0.5 * t2;
+      sx.push_back(w0 * xs[p0] + w1 * xs[p1] + w2 * xs[p2] + w3 * xs[p3]);
+      sy.push_back(w0 * ys[p0] + w1 * ys[p1] + w2 * ys[p2] + w3 * ys[p3]);
+    }
+  }
+  return Track(sx, sy);
+}
+
+bool Track::load(const string &path) {
+  ifstream in(path.c_str());
+  if (!in) {
+    return false;
+  }
+  vector<double> x, y;
+  string line;
+  while (getline(in, line)) {
+    size_t start = line.find_first_not_of(" \t\r");
+    if (start == string::npos || line[start] == '#') {
+      continue;
+    }
+    istringstream fields(line);
+    double px, py;
+    if (!(fields >> px >> py)) {
+      return false;
+    }
+    x.push_back(px);
+    y.push_back(py);
+  }
+  try {
+    *this = Track(x, y);
+  } catch (const char *) {
+    return false;
+  }
+  return true;
+}
+
+double Track::getHeading(int i) const {
+  int next = (i + 1) % size();
+  return atan2(ys[next] - ys[i], xs[next] - xs[i]);
+}
+
+double Track::project(int i, double x, double y, TrackPosition &position) const {
+  int next = (i + 1) % size();
+  double dx = xs[next] - xs[i], dy = ys[next] - ys[i];
+  double length = distances[i + 1] - distances[i];
+  double px = x - xs[i], py = y - ys[i];
+  // the nearest point on the segment as a fraction of the segment
+  double t = (px * dx + py * dy) / (length * length);
+  t = t < 0? 0: (t > 1? 1: t);
+  double ex = px - t * dx, ey = py - t * dy;
+  position.segment = i;
+  position.distance = distances[i] + t * length;
+  // the point is on the right when it is clockwise from the direction of the segment
+  double side = dx * py - dy * px;
+  double d = hypot(ex, ey);
+  position.cte = side > 0? -d: d;
+  position.heading = atan2(dy, dx);
+  position.curvature = curvatures[i] + t * (curvatures[next] - curvatures[i]);
+  return ex * ex + ey * ey;
+}
+
+double Track::distance(int i, double x, double y) const {
+  int next = i + 1 < size()? i + 1: 0;
+  double dx = xs[next] - xs[i], dy = ys[next] - ys[i];
+  double px = x - xs[i], py = y - ys[i];
+  double t = (px * dx + py * dy) / (dx * dx + dy * dy);
+  t = t < 0? 0: (t > 1? 1: t);
+  double ex = px - t * dx, ey = py - t * dy;
+  return ex * ex + ey * ey;
+}
+
+double Track::distance(int i, int j) const {
+  int n = size();
+  double ax = xs[i], ay = ys[i], bx = xs[(i + 1) % n], by = ys[(i + 1) % n];
+  double cx = xs[j], cy = ys[j], dx = xs[(j + 1) % n], dy = ys[(j + 1) % n];
+  // crossing segments, where the track crosses itself
+  double o1 = (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+  double o2 = (bx - ax) * (dy - ay) - (by - ay) * (dx - ax);
+  double o3 = (dx - cx) * (ay - cy) - (dy - cy) * (ax - cx);
+  double o4 = (dx - cx) * (by - cy) - (dy - cy) * (bx - cx);
+  if (o1 * o2 < 0 && o3 * o4 < 0) {
+    return 0;
+  }
+  // otherwise the nearest points include an end of one of the segments
+  return fmin(fmin(distance(i, cx, cy), distance(i, dx, dy)), fmin(distance(j, ax, ay), distance(j, bx, by)));
+}
+
+/**
+ * Return the squared distance from a point to a box
+ */
+static inline double boxDistance(double x, double y, double min_x, double min_y, double max_x, double max_y) {
+  double dx = x < min_x? min_x - x: (x > max_x? x - max_x: 0);
+  double dy = y < min_y? min_y - y: (y > max_y? y - max_y: 0);
+  return dx * dx + dy * dy;
+}
+
+void Track::search(double x, double y, int &best, double &best_distance) const {
+  // the depth of the hierarchy is log2 of the number of segments
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const Node &node = nodes[stack[--top]];
+    // nodes at the same distance may have segments with lower indices, so they are not skipped.
+    // The distances to boxes and segments are rounded differently, so the tie has a tolerance
+    if (boxDistance(x, y, node.min_x, node.min_y, node.max_x, node.max_y) > best_distance * (1 + 1e-9)) {
+      continue;
+    }
+    if (node.left < 0) {
+      for (int i = node.first; i < node.first + node.count; i++) {
+        double d = distance(i, x, y);
+        if (d < best_distance || (d == best_distance && i < best)) {
+          best_distance = d;
+          best = i;
+        }
+      }
+    } else {
+      // visit the nearer child first, it is pushed last
+      const Node &left = nodes[node.left];
+      const Node &right = nodes[node.right];
+      double dl = boxDistance(x, y, left.min_x, left.min_y, left.max_x, left.max_y);
+      double dr = boxDistance(x, y, right.min_x, right.min_y, right.max_x, right.max_y);
+      if (dl <= dr) {
+        stack[top++] = node.right;
+        stack[top++] = node.left;
+      } else {
+        stack[top++] = node.left;
+        stack[top++] = node.right;
+      }
+    }
+  }
+}
+
+/**
+ * Return the squared distance between two boxes
+ */
+static inline double boxDistance(const double a[4], double min_x, double min_y, double max_x, double max_y) {
+  double dx = fmax(0, fmax(min_x - a[2], a[0] - max_x));
+  double dy = fmax(0, fmax(min_y - a[3], a[1] - max_y));
+  return dx * dx + dy * dy;
+}
+
+double Track::clearance(int i) const {
+  int n = size();
+  int next = (i + 1) % n;
+  double box[4] = {fmin(xs[i], xs[next]), fmin(ys[i], ys[next]), fmax(xs[i], xs[next]), fmax(ys[i], ys[next])};
+  double best_distance = INFINITY;
+  int stack[64];
+  int top = 0;
+  stack[top++] = 0;
+  while (top > 0) {
+    const Node &node = nodes[stack[--top]];
+    if (boxDistance(box, node.min_x, node.min_y, node.max_x, node.max_y) >= best_distance) {
+      continue;
+    }
+    if (node.left < 0) {
+      for (int j = node.first; j < node.first + node.count; j++) {
+        int apart = abs(j - i);
+        if (min(apart, n - apart) > NEIGHBOURS) {
+          best_distance = fmin(best_distance, distance(i, j));
+        }
+      }
+    } else {
+      stack[top++] = node.right;
+      stack[top++] = node.left;
+    }
+  }
+  return sqrt(best_distance);
+}
+
+TrackPosition Track::locate(double x, double y) const {
+  int best = size();
+  double best_distance = INFINITY;
+  search(x, y, best, best_distance);
+  TrackPosition position;
+  project(best, x, y, position);
+  return position;
+}
+
+TrackPosition Track::locate(double x, double y, int &hint) const {
+  int n = size();
+  int best = n;
+  double best_distance = INFINITY;
+  if (hint >= 0 && hint < n) {
+    // follow the track from the hint, in the direction of the nearer neighbour, while the segments
+    // get nearer
+    int nearest = hint;
+    double nearest_distance = distance(hint, x, y);
+    int next = hint + 1 < n? hint + 1: 0, prev = hint > 0? hint - 1: n - 1;
+    double dn = distance(next, x, y), dp = distance(prev, x, y);
+    int direction = dn <= dp? 1: n - 1;
+    int i = dn <= dp? next: prev;
+    double d = fmin(dn, dp);
+    for (int step = 0; step < MAX_WALK && d < nearest_distance; step++) {
+      nearest = i;
+      nearest_distance = d;
+      i = (i + direction) % n;
+      d = distance(i, x, y);
+    }
+    // every other segment is at least the clearance less the distance to the segment away, so the
+    // nearest segment is one of the neighbours if the point is within half of the clearance. The
+    // distances are rounded differently, so the clearance has a tolerance
+    if (2 * sqrt(nearest_distance) < clearances[nearest] * (1 - 1e-9)) {
+      // the nearest of the neighbours, of which the one with the lowest index on a tie
+      for (int k = -NEIGHBOURS; k <= NEIGHBOURS; k++) {
+        int i = (nearest + k + n) % n;
+        double d = distance(i, x, y);
+        if (d < best_distance || (d == best_distance && i < best)) {
+          best_distance = d;
+          best = i;
+        }
+      }
+    } else {
+      best = nearest;
+      best_distance = nearest_distance;
+      search(x, y, best, best_distance);
+    }
+  } else {
+    search(x, y, best, best_distance);
+  }
+  hint = best;
+  TrackPosition position;
+  project(best, x, y, position);
+  return position;
+}
+
+TrackPosition Track::locateLinear(double x, double y) const {
+  int best = 0;
+  double best_distance = INFINITY;
+  for (int i = 0; i < size(); i++) {
+    double d = distance(i, x, y);
+    if (d < best_distance) {
+      best_distance = d;
+      best = i;
+    }
+  }
+  TrackPosition position;
+  project(best, x, y, position);
+  return position;
+}
@@ -0,0 +1,215 @@
+#ifndef _SIM_TRACK_H_
+#define _SIM_TRACK_H_
+
+#include <string>
+#include <vector>
+#include "../utils/MathUtils.h"
+
+using namespace std;
+
+/**
+ * Position of a point relative to the track
+ */
+struct TrackPosition {
+  int segment;      // index of the nearest segment
+  double distance;  // distance along the track from the first point to the nearest point
+  double cte;       // cross track error, positive on the right side of the track
+  double heading;   // direction of the track at the nearest point in radians
+  double curvature; // curvature of the track at the nearest point, positive for left turns
+
+  /**
+   * Return the heading error of a car, positive if the car points to the left of the track
+   * @param yaw the yaw angle of the car
+   */
+  double headingError(double yaw) const { return normalizeAngle(yaw - heading); }
+};
+
+/**
+ * Track is the center line of a closed course, a polyline whose last point connects to the first.
+ * A track can be built from points, smoothed with a Catmull-Rom spline through the points, or
+ * loaded from a text file with the x and y coordinates of a point on each line. Lines starting
+ * with # are comments.
+ * The nearest segment of a point is found with a bounding volume hierarchy over the segments.
+ * Consecutive segments are close to each other, so every node covers a contiguous range of
+ * segments, and its children split the range in halves. The hierarchy is searched nearest child
+ * first, and nodes farther than the nearest segment found so far are skipped, so a search visits
+ * O(log n) nodes regardless of the number of points.
+ * A car moves a few segments per step, so the nearest segment of the last step, the hint, is
+ * followed along the track to the nearest segment around it instead. Every segment keeps its
+ * clearance, the distance to the segments that are not its neighbours, and a point nearer to a
+ * segment than half of its clearance is nearer to its neighbours than to any other segment. The
+ * hierarchy is searched only when the point is farther, e.g. when the car has moved far from the
+ * hint or left the track.
+ */
+class Track {
+  /**
+   * A node of the bounding volume hierarchy
+   */
+  struct Node {
+    double min_x, min_y, max_x, max_y; // the bounding box of the segments
+    int first, count;                  // the range of the segments
+    int left, right;                   // the children, -1 for leaves
+  };
+
+  // maximal number of segments of a leaf
+  static const int LEAF_SIZE = 4;
+  // number of neighbours on each side of a segment compared with it when following the hint
+  static const int NEIGHBOURS = 4;
+  // maximal number of segments followed from the hint
+  static const int MAX_WALK = 8;
+
+  // x coordinates of the points
+  vector<double> xs;
+  // y coordinates of the points
+  vector<double> ys;
+  // distance along the track of each point, with the length of the track at the end
+  vector<double> distances;
+  // curvature at each point
+  vector<double> curvatures;
+  // the bounding volume hierarchy, the first node is the root
+  vector<Node> nodes;
+  // distance from each segment to the nearest segment that is not one of its neighbours
+  vector<double> clearances;
+
+  /**
+   * Compute the distances and curvatures of the points, and build the hierarchy
+   */
+  void build();
+
+  /**
+   * Build a node of the hierarchy and its children
+   * @param first the first segment of the node
+   * @param count the number of segments of the node
+   * @return index of the node
+   */
+  int buildNode(int first, int count);
+
+  /**
+   * Search the hierarchy for the segment nearest to a point
+   * @param x x coordinate of the point
+   * @param y y coordinate of the point
+   * @param best the nearest segment found so far, updated if a nearer segment is found
+   * @param best_distance the squared distance to the nearest segment found so far
+   */
+  void search(double x, double y, int &best, double &best_distance) const;
+
+  /**
+   * Search the hierarchy for the distance from a segment to the nearest segment that is not one of
+   * its neighbours
+   * @param i index of the segment
+   */
+  double clearance(int i) const;
+
+  /**
+   * Return the squared distance from a point to a segment
+   * @param i index of the segment
+   * @param x x coordinate of the point
+   * @param y y coordinate of the point
+   */
+  double distance(int i, double x, double y) const;
+
+  /**
+   * Return the squared distance between two segments
+   * @param i index of a segment
+   * @param j index of the other segment
+   */
+  double distance(int i, int j) const;
+
+public:
+  /**
+   * Constructor, constructs an empty track
+   */
+  Track();
+
+  /**
+   * Constructor
+   * @param xs x coordinates of the points
+   * @param ys y coordinates of the points
+   */
+  Track(const vector<double> &xs, const vector<double> &ys);
+
+  /**
+   * Return a stadium shaped track running counterclockwise, two straights joined by two half circles
+   * @param straight length of the straights
+   * @param radius radius of the half circles
+   * @param spacing the maximal distance between points
+   */
+  static Track oval(double straight, double radius, double spacing);
+
+  /**
+   * Return the Catmull-Rom spline through the points of this track
+   * @param samples number of points per segment
+   */
+  Track spline(int samples) const;
+
+  /**
+   * Load a track from a text file
+   * @param path the file path
+   * @return true if successful
+   */
+  bool load(const string &path);
+
+  /**
+   * Return the number of points, which is also the number of segments
+   */
+  int size() const { return (int)xs.size(); }
+
+  /**
+   * Return the length of the track
+   */
+  double getLength() const { return distances.empty()? 0: distances.back(); }
+
+  double getX(int i) const { return xs[i]; }
+  double getY(int i) const { return ys[i]; }
+
+  /**
+   * Return the direction of the track from a point to the next one
+   * @param i index of the point
+   */
+  double getHeading(int i) const;
+
+  /**
+   * Return the curvature of the track at a point
+   * @param i index of the point
+   */
+  double getCurvature(int i) const { return curvatures[i]; }
+
+  /**
+   * Locate a point relative to the track, by finding the nearest segment. Of segments at the
+   * same distance, the one with the lowest index is the nearest
+   * @param x x coordinate of the point
+   * @param y y coordinate of the point
+   * @return the position of the point
+   */
+  TrackPosition locate(double x, double y) const;
+
+  /**
+   * Locate a point near the position of a previous point
+   * @param x x coordinate of the point
+   * @param y y coordinate of the point
+   * @param hint the nearest segment of the previous point, or -1 for none. It receives the
+   * nearest segment of this point
+   * @return the position of the point, the same as locate(x, y)
+   */
+  TrackPosition locate(double x, double y, int &hint) const;
+
+  /**
+   * Locate a point relative to the track by comparing all the segments, for verification
+   * @param x x coordinate of the point
+   * @param y y coordinate of the point
+   * @return the position of the point
+   */
+  TrackPosition locateLinear(double x, double y) const;
+
+  /**
+   * Compute the position of a point relative to a segment
+   * @param i index of the segment
+   * @param x x coordinate of the point
+   * @param y y coordinate of the point
+   * @param position receives the position
+   * @return the squared distance from the point to the segment
+   */
+  double project(int i, double x, double y, TrackPosition &position) const;
+};
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef _SIM_TRAJECTORYSINK_H_
+#define _SIM_TRAJECTORYSINK_H_
+
+#include <stddef.h>
+
+/**
+ * The state of the car after a step of a run
+ */
+struct TrajectoryPoint {
+  double x;         // x coordinate
+  double y;         // y coordinate
+  double yaw;       // the yaw angle
+  double velocity;  // velocity along the yaw angle
+  double control;   // the control value of the step
+  double error;     // the error of the controller in the step
+};
+
+/**
+ * TrajectorySink receives the trajectory of a run step by step, so that a run records its
+ * trajectory without knowing where it goes, e.g. to memory for plotting, or to a file.
+ */
+class TrajectorySink {
+public:
+  virtual ~TrajectorySink() {}
+
+  /**
+   * Called before a run records its points, so that the sink can make room for them
+   * @param steps number of points the run will record
+   */
+  virtual void begin(size_t steps) {}
+
+  /**
+   * Record the point of a step
+   * @param point the point
+   */
+  virtual void record(const TrajectoryPoint &point) = 0;
+};
+
+#endif
@@ -0,0 +1,160 @@
+#include "Vehicle.h"
+#include "../utils/FastMath.h"
+
+// the Butcher tableau of the Dormand-Prince 5(4) pair, whose nodes are not needed since the model
+// does not depend on time: the coefficients of the stages, the fifth order weights, which are the
+// coefficients of the last stage, and the differences of the fifth and fourth order weights
+static const double DP_A[7][6] = {
+  {0},
+  {1.0 / 5},
+  {3.0 / 40, 9.0 / 40},
+  {44.0 / 45, -56.0 / 15, 32.0 / 9},
+  {19372.0 / 6561, -25360.0 / 2187, 64448.0 / 6561, -212.0 / 729},
+  {9017.0 / 3168, -355.0 / 33, 46732.0 / 5247, 49.0 / 176, -5103.0 / 18656},
+  {35.0 / 384, 0, 500.0 / 1113, 125.0 / 192, -2187.0 / 6784, 11.0 / 84}
+};
+static const double DP_E[7] = {71.0 / 57600, 0, -71.0 / 16695, 71.0 / 1920, -17253.0 / 339200, 22.0 / 525, -1.0 / 40};
+
+// the most substeps of a step of the adaptive integrator, and the least substep relative to the step
+#define MAX_SUBSTEPS 1000
+#define MIN_SUBSTEP 1E-9
+
+Vehicle::Vehicle(double length, double x, double y, double yaw, double velocity):
+  length(length), x(x), y(y), yaw(yaw), velocity(velocity) {}
+
+void Vehicle::setLimits(double max_steering, double max_acceleration, double max_deceleration, double max_velocity) {
+  this->max_steering = max_steering;
+  this->max_acceleration = max_acceleration;
+  this->max_deceleration = max_deceleration;
+  this->max_velocity = max_velocity;
+}
+
+void Vehicle::move(double dt, double steering, double acceleration) {
+  if (integrator == ARC_INTEGRATOR && !fast_math) {
+    moveArc(x, y, yaw, velocity, dt, steering, acceleration);
+    return;
+  }
+
+  // clamp the steering angle
+  if (steering > max_steering) steering = max_steering;
+  if (steering < -max_steering) steering = -max_steering;
+
+  if (acceleration > max_acceleration) acceleration = max_acceleration;
+  if (acceleration < max_deceleration) acceleration = max_deceleration;
+
+  if (integrator == RK4_INTEGRATOR) {
+    moveRK4(dt, steering, acceleration);
+  } else if (integrator == ADAPTIVE_INTEGRATOR) {
+    moveAdaptive(dt, steering, acceleration);
+  } else {
+    moveFast(dt, steering, acceleration);
+  }
+}
+
+void Vehicle::moveFast(double dt, double steering, double acceleration) {
+  double dist = (velocity + acceleration * dt / 2) * dt;
+  double turn = fastTan(steering) * dist / length;
+
+  // the displacement along and to the left of the yaw
+  double forward = dist, left = 0;
+  if (fabs(turn) > MIN_TURN) {
+    // the chord of the arc is 2 * radius * sin(turn / 2) at half the turn from the yaw, so that
+    // 1 - cos(turn) is not computed from nearly equal numbers
+    double radius = dist / turn;
+    double s, c;
+    if (fabs(turn) <= M_PI_2) {
+      fastSinCosSmall(turn / 2, s, c);
+    } else {
+      fastSinCos(turn / 2, s, c);
+    }
+    forward = 2 * radius * s * c;
+    left = 2 * radius * s * s;
+  }
+  double sin_yaw, cos_yaw;
+  fastSinCos(yaw, sin_yaw, cos_yaw);
+  x += forward * cos_yaw - left * sin_yaw;
+  y += forward * sin_yaw + left * cos_yaw;
+
+  velocity += acceleration * dt;
+  if (velocity > max_velocity) velocity = max_velocity;
+  yaw = wrapAngle(yaw + turn);
+}
+
+void Vehicle::derivative(const double *state, double tan_steering, double acceleration, double *derivative) const {
+  derivative[0] = state[3] * cos(state[2]);
+  derivative[1] = state[3] * sin(state[2]);
+  derivative[2] = state[3] * tan_steering / length;
+  // the car stops accelerating at its maximal velocity
+  derivative[3] = state[3] >= max_velocity && acceleration > 0? 0: acceleration;
+}
+
+void Vehicle::moveRK4(double dt, double steering, double acceleration) {
+  double tan_steering = tan(steering);
+  double state[4] = {x, y, yaw, velocity}, k[4][4], stage[4];
+  derivative(state, tan_steering, acceleration, k[0]);
+  for (int s = 1; s < 4; s++) {
+    double h = s == 3? dt: dt / 2;
+    for (int j = 0; j < 4; j++) {
+      stage[j] = state[j] + h * k[s - 1][j];
+    }
+    derivative(stage, tan_steering, acceleration, k[s]);
+  }
+  for (int j = 0; j < 4; j++) {
+    state[j] += dt / 6 * (k[0][j] + 2 * k[1][j] + 2 * k[2][j] + k[3][j]);
+  }
+  x = state[0];
+  y = state[1];
+  yaw = normalizeAngle(state[2]);
+  velocity = fmin(state[3], max_velocity);
+}
+
+void Vehicle::moveAdaptive(double dt, double steering, double acceleration) {
+  double tan_steering = tan(steering);
+  double state[4] = {x, y, yaw, velocity}, k[7][4], stage[4];
+  double t = 0, h = dt;
+  derivative(state, tan_steering, acceleration, k[0]);
+  for (int n = 0; n < MAX_SUBSTEPS && t < dt; n++) {
+    // the last of the substeps covers the rest of the step, whatever its error
+    bool forced = n == MAX_SUBSTEPS - 1 || h <= dt * MIN_SUBSTEP;
+    bool last = h >= dt - t || n == MAX_SUBSTEPS - 1;
+    if (last) {
+      h = dt - t;
+    }
+    for (int s = 1; s < 7; s++) {
+      for (int j = 0; j < 4; j++) {
+        stage[j] = state[j];
+        for (int r = 0; r < s; r++) {
+          stage[j] += h * DP_A[s][r] * k[r][j];
+        }
+      }
+      derivative(stage, tan_steering, acceleration, k[s]);
+    }
+    // the error of the fourth order solution, with the yaw and the velocity scaled to distances
+    double scale[4] = {1, 1, length, 1}, error = 0;
+    for (int j = 0; j < 4; j++) {
+      double e = 0;
+      for (int s = 0; s < 7; s++) {
+        e += DP_E[s] * k[s][j];
+      }
+      error = fmax(error, fabs(h * e) * scale[j]);
+    }
+    if (error <= tolerance || forced) {
+      if (error > tolerance) {
+        forced_substeps++;
+      }
+      // the last stage is the fifth order solution, and its derivative is the first of the next substep
+      for (int j = 0; j < 4; j++) {
+        state[j] = stage[j];
+        k[0][j] = k[6][j];
+      }
+      t = last? dt: t + h;
+    }
+    double factor = error > 0? 0.9 * pow(tolerance / error, 0.2): 5;
+    h *= fmax(0.2, fmin(5.0, factor));
+    h = fmax(h, dt * MIN_SUBSTEP);
+  }
+  x = state[0];
+  y = state[1];
+  yaw = normalizeAngle(state[2]);
+  velocity = fmin(state[3], max_velocity);
+}
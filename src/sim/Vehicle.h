@@ -0,0 +1,222 @@
+#ifndef _SIM_VEHICLE_H_
+#define _SIM_VEHICLE_H_
+
+#include <math.h>
+#ifdef VERBOSE_OUT
+#include <iostream>
+#endif
+#include "../utils/MathUtils.h"
+
+/**
+ * Vehicle is the kinematic bicycle model of a car: it moves along a circular arc determined by
+ * the steering angle and the wheel base within a step, and accelerates uniformly. The steering
+ * angle, the acceleration, and the velocity are clamped to the limits of the car.
+ * With fast math, the step is computed with the approximations of FastMath instead of the math
+ * library: the arc is a chord at half the turn from the yaw, so a step takes the sine and cosine of
+ * the yaw and of half the turn, and the tangent of the steering angle, of which only the yaw needs
+ * reduction, instead of a tangent, four sines and cosines, and the loops of normalizeAngle. The
+ * positions differ from the exact ones by less than 1e-9 per step.
+ * The arc is the exact solution of the model for the steering angle and the acceleration held over
+ * the step, except that the velocity is clamped at the end of the step. The model can also be
+ * integrated numerically, with the classic fourth order Runge-Kutta method in one step, or with
+ * the Dormand-Prince 5(4) pair in as many substeps as it takes to keep the error of every
+ * substep within a tolerance, which also finds when the velocity reaches its limit within a step.
+ * The arc is templated on the scalar type, so that a run can be differentiated with dual numbers.
+ */
+class Vehicle {
+public:
+  /*
+  * Integrators of the steps
+  */
+  static const int ARC_INTEGRATOR = 0;       // the arc in closed form
+  static const int RK4_INTEGRATOR = 1;       // the fourth order Runge-Kutta method
+  static const int ADAPTIVE_INTEGRATOR = 2;  // the Dormand-Prince 5(4) pair with adaptive substeps
+
+  // the least turn of a step along an arc rather than a straight line
+  static constexpr double MIN_TURN = 1E-6;
+
+private:
+  // length of the car
+  double length;
+  // x coordinate
+  double x;
+  // y coordinate
+  double y;
+  // the yaw angle in [-pi, pi)
+  double yaw;
+  // velocity along the yaw angle
+  double velocity;
+
+  /*
+  * Limits
+  */
+  double max_steering = M_PI/ 6.667;
+  double max_acceleration = 8;
+  double max_deceleration = -20;
+  double max_velocity = 100;
+
+  // true to compute the steps with the fast approximations
+  bool fast_math = false;
+  // the integrator of the steps
+  int integrator = ARC_INTEGRATOR;
+  // the error tolerance of a substep of the adaptive integrator
+  double tolerance = 1e-9;
+  // number of substeps of the adaptive integrator taken above the tolerance
+  long long forced_substeps = 0;
+
+  /**
+   * Move the car with the fast approximations. Like move, it branches between a straight step and
+   * an arc, and it reduces half the turn only when it exceeds pi / 4
+   * @param dt the time to move
+   * @param steering the clamped steering angle
+   * @param acceleration the clamped acceleration
+   */
+  void moveFast(double dt, double steering, double acceleration);
+
+  /**
+   * Compute the derivative of the state of the model, the coordinates, the yaw and the velocity
+   * @param state the state
+   * @param tan_steering the tangent of the clamped steering angle
+   * @param acceleration the clamped acceleration
+   * @param derivative receives the derivative of the state
+   */
+  void derivative(const double *state, double tan_steering, double acceleration, double *derivative) const;
+
+  /**
+   * Move the car with the fourth order Runge-Kutta method
+   * @param dt the time to move
+   * @param steering the clamped steering angle
+   * @param acceleration the clamped acceleration
+   */
+  void moveRK4(double dt, double steering, double acceleration);
+
+  /**
+   * Move the car with the Dormand-Prince 5(4) pair in adaptive substeps. A substep is taken above
+   * the tolerance when it cannot get any shorter, and the last substep covers the rest of the step
+   * when the step runs out of substeps, so the car always moves the whole step
+   * @param dt the time to move
+   * @param steering the clamped steering angle
+   * @param acceleration the clamped acceleration
+   */
+  void moveAdaptive(double dt, double steering, double acceleration);
+
+public:
+  /**
+   * Constructor
+   * @param length length of the car
+   * @param x x coordinate of the car
+   * @param y y coordinate of the car
+   * @param yaw the yaw angle
+   * @param velocity velocity of the car alone the yaw angle
+   */
+  Vehicle(double length = 2.5, double x = 0, double y = 0, double yaw = 0, double velocity = 0);
+
+  /**
+   * Set the limits of the car
+   * @param max_steering the maximal absolute steering angle
+   * @param max_acceleration the maximal acceleration
+   * @param max_deceleration the maximal deceleration, a negative number
+   * @param max_velocity the maximal velocity
+   */
+  void setLimits(double max_steering, double max_acceleration, double max_deceleration, double max_velocity);
+
+  double getLength() const { return length; }
+  double getX() const { return x; }
+  double getY() const { return y; }
+  double getYaw() const { return yaw; }
+  double getVelocity() const { return velocity; }
+
+  /**
+   * Compute the steps with the fast approximations or the math library
+   * @param fast true for the fast approximations
+   */
+  void setFastMath(bool fast) { fast_math = fast; }
+
+  bool getFastMath() const { return fast_math; }
+
+  /**
+   * Set the integrator of the steps, the fast approximations apply to the arc only
+   * @param integrator ARC_INTEGRATOR, RK4_INTEGRATOR or ADAPTIVE_INTEGRATOR
+   */
+  void setIntegrator(int integrator) { this->integrator = integrator; }
+
+  int getIntegrator() const { return integrator; }
+
+  /**
+   * Set the error tolerance of the adaptive integrator
+   * @param tolerance the most error of a substep in the coordinates, in the yaw times the length of
+   * the car, and in the velocity times a second
+   */
+  void setTolerance(double tolerance) { this->tolerance = tolerance; }
+
+  /**
+   * Return the number of substeps of the adaptive integrator taken above the tolerance, which are
+   * less accurate than the tolerance asks
+   */
+  long long getForcedSubsteps() const { return forced_substeps; }
+
+  /**
+   * Set the velocity
+   */
+  void setVelocity(double value) { velocity = value; }
+
+  /**
+   * Move a state of the car along the arc of a step, with the steering angle and the acceleration
+   * clamped to the limits of the car
+   * @param x the x coordinate to update
+   * @param y the y coordinate to update
+   * @param yaw the yaw angle to update
+   * @param velocity the velocity to update
+   * @param dt the time to move
+   * @param steering the steering angle, positive to turn counterclockwise
+   * @param acceleration the acceleration
+   */
+  template<typename T> void moveArc(T &x, T &y, T &yaw, T &velocity, double dt, T steering, T acceleration) const;
+
+  /**
+   * Move the car
+   * @param dt the time to move
+   * @param steering the steering angle, positive to turn counterclockwise
+   * @param acceleration the acceleration
+   */
+  void move(double dt, double steering, double acceleration = 0);
+};
+
+template<typename T> void Vehicle::moveArc(T &x, T &y, T &yaw, T &velocity, double dt, T steering, T acceleration) const {
+  // clamp the steering angle
+  if (steering > max_steering) steering = max_steering;
+  if (steering < -max_steering) steering = -max_steering;
+
+  if (acceleration > max_acceleration) acceleration = max_acceleration;
+  if (acceleration < max_deceleration) acceleration = max_deceleration;
+
+  T dist = (velocity + acceleration * dt / 2) * dt;
+  // Compute turing angle from steering angle
+  T turn = tan(steering) * dist / length;
+  T new_yaw = normalizeAngle(yaw + turn);
+
+  if (fabs(turn) > MIN_TURN) {  // turn is not 0
+    // Compute the turn radius
+    T radius = dist / turn; // del psi = turn / dt
+    // update x and y
+    x += radius * (sin(new_yaw) - sin(yaw));
+    y += radius * (cos(yaw) - cos(new_yaw));
+
+  #ifdef VERBOSE_OUT
+    std::cout << "Move: " << turn << " " << yaw << " " << new_yaw << " " << dist << " " << steering
+              << " " << radius <<  " " << acceleration << " " << velocity << std::endl;
+  #endif
+  } else {  // turn is 0
+    // update x and y
+    x += dist * cos(yaw);
+    y += dist * sin(yaw);
+  }
+
+  // update velocity
+  velocity += acceleration * dt;
+  if (velocity > max_velocity) velocity = max_velocity;
+  // update yaw
+  yaw = new_yaw;
+}
+
+#endif
@@ -0,0 +1,154 @@
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "control/DriveSettings.h"
+#include "sim/ClosedLoop.h"
+#include "sim/Track.h"
+#include "utils/ThreadPool.h"
+
+/**
+ * Drive the laps with the given steering stages
+ * @param settings settings of the driving pipeline
+ * @param track the track
+ * @param options the lap options
+ * @param pool the threads to drive the laps on
+ * @param results receives the scores of the laps, the size is the number of laps
+ */
+template<class Steering> void driveLaps(const DriveSettings &settings, const Track &track, const LapOptions &options,
+    ThreadPool &pool, std::vector<LapResult> &results) {
+  ClosedLoop<Steering> loop(settings, track, options);
+  // every task drives a batch of laps, so that the tasks are not dominated by the scheduling
+  const size_t BATCH = 16;
+  for (size_t first = 0; first < results.size(); first += BATCH) {
+    pool.submit([&loop, &results, first, BATCH]() {
+      for (size_t i = first; i < std::min(first + BATCH, results.size()); i++) {
+        results[i] = loop.run((unsigned)i);
+      }
+    });
+  }
+  pool.wait();
+}
+
+int main(int argc, char* argv[]) {
+  DriveSettings settings;
+  LapOptions options;
+  int laps = 100; // number of laps
+  int threads = 0; // number of threads, 0 for the number of hardware threads
+  std::string track_file = ""; // the track file, empty for the oval track
+  int samples = 0; // points per segment of the spline through the track points, 0 for no spline
+  double oval[2] = {300, 80}; // length of the straights and radius of the turns of the oval track
+
+  // Process command line options
+  for (int i = 1; i < argc; i++) {
+    if (settings.parseOption(argv, i)) {
+      continue;
+    } else if (std::string((argv[i])) == "-laps") { // number of laps
+      if (sscanf(argv[++i], "%d", &laps) != 1 || laps <= 0) {
+        std::cerr << "Invalid laps: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-threads") { // number of threads
+      if (sscanf(argv[++i], "%d", &threads) != 1 || threads < 0) {
+        std::cerr << "Invalid threads: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-track") { // track file
+      track_file = argv[++i];
+    } else if (std::string((argv[i])) == "-spline") { // spline through the track points
+      if (sscanf(argv[++i], "%d", &samples) != 1 || samples <= 0) {
+        std::cerr << "Invalid spline samples: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-oval") { // the oval track
+      if (sscanf(argv[++i], "%lf", &oval[0]) != 1 || oval[0] <= 0) {
+        std::cerr << "Invalid straight length: " << argv[i] << std::endl;
+        exit(-1);
+      }
+      if (sscanf(argv[++i], "%lf", &oval[1]) != 1 || oval[1] <= 0) {
+        std::cerr << "Invalid turn radius: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-dt") { // interval between messages
+      if (sscanf(argv[++i], "%lf", &options.dt) != 1 || options.dt <= 0) {
+        std::cerr << "Invalid dt: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-width") { // half width of the track
+      if (sscanf(argv[++i], "%lf", &options.half_width) != 1 || options.half_width <= 0) {
+        std::cerr << "Invalid width: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-max_time") { // time limit of a lap
+      if (sscanf(argv[++i], "%lf", &options.max_time) != 1 || options.max_time <= 0) {
+        std::cerr << "Invalid max time: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-noise") { // acceleration and steering noise
+      if (sscanf(argv[++i], "%lf", &options.noise[0]) != 1 || options.noise[0] < 0) {
+        std::cerr << "Invalid acceleration noise: " << argv[i] << std::endl;
+        exit(-1);
+      }
+      if (sscanf(argv[++i], "%lf", &options.noise[1]) != 1 || options.noise[1] < 0) {
+        std::cerr << "Invalid steering noise: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else {
+      std::cerr << "Unknown option: " << argv[i] << std::endl;
+      exit(-1);
+    }
+  }
+  settings.finish();
+
+  Track track;
+  if (track_file.empty()) {
+    track = Track::oval(oval[0], oval[1], 1);
+  } else if (!track.load(track_file)) {
+    std::cerr << "Invalid track: " << track_file << std::endl;
+    exit(-1);
+  }
+  if (samples > 0) {
+    track = track.spline(samples);
+  }
+
+  // Drive the laps in parallel
+  std::vector<LapResult> results(laps);
+  ThreadPool pool(threads);
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  settings.withSteering([&](auto steering) {
+    driveLaps<decltype(steering)>(settings, track, options, pool, results);
+  });
+  double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Summarize the scores
+  std::vector<double> times;
+  double max_cte = 0, rms_cte = 0, smoothness = 0, speed = 0;
+  long long steps = 0;
+  for (size_t i = 0; i < results.size(); i++) {
+    const LapResult &result = results[i];
+    if (result.completed) {
+      times.push_back(result.time);
+    }
+    max_cte = std::max(max_cte, result.max_cte);
+    rms_cte += result.rms_cte / laps;
+    smoothness += result.smoothness / laps;
+    speed += result.mean_speed / laps;
+    steps += result.steps;
+  }
+  std::sort(times.begin(), times.end());
+  std::cout << "Track: " << track.size() << " points, length " << track.getLength() << std::endl;
+  std::cout << "Laps completed: " << times.size() << " of " << laps << std::endl;
+  if (!times.empty()) {
+    std::cout << "Lap time: median " << times[times.size() / 2] << ", min " << times.front()
+              << ", max " << times.back() << std::endl;
+  }
+  std::cout << "Max CTE: " << max_cte << ", mean RMS CTE: " << rms_cte << std::endl;
+  std::cout << "Mean smoothness: " << smoothness << ", mean speed: " << speed << std::endl;
+  std::cout << "Simulated " << steps << " steps in " << wall << " seconds, "
+            << std::fixed << std::setprecision(0) << laps * 60 / wall << " laps per minute on "
+            << pool.size() << " threads" << std::endl;
+  // fail if any lap is not completed, so that regressions can be scripted
+  return (int)times.size() == laps? 0: 1;
+}
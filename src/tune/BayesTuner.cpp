@@ -0,0 +1,174 @@
+#include <float.h>
+#include <math.h>
+#include <algorithm>
+#include "BayesTuner.h"
+
+// the least error whose logarithm is taken, and the logarithm of errors that are not finite
+#define MIN_ERROR 1e-300
+#define MAX_LOG_ERROR 700
+// number of random candidate points of a proposal, over the box and around the best points
+#define CANDIDATES 512
+// number of best points whose neighborhoods are searched
+#define NEIGHBORHOODS 4
+// number of perturbations refining the best candidate
+#define REFINEMENTS 64
+
+/**
+ * Return the logarithm of an error
+ */
+static double logError(double error) {
+  if (!(error <= DBL_MAX)) {
+    return MAX_LOG_ERROR;
+  }
+  return log(fmax(error, MIN_ERROR));
+}
+
+BayesTuner::BayesTuner(const VectorXd &lower, const VectorXd &upper, int batch, unsigned seed):
+    lower(lower), upper(upper), batch(batch > 0? batch: 1), generator(seed) {}
+
+double BayesTuner::expectedImprovement(double mean, double deviation, double best) {
+  double improvement = best - mean;
+  if (deviation <= 0) {
+    return fmax(improvement, 0);
+  }
+  double z = improvement / deviation;
+  return improvement * 0.5 * erfc(-z / sqrt(2.0)) + deviation * exp(-z * z / 2) / sqrt(2 * M_PI);
+}
+
+VectorXd BayesTuner::propose(const GaussianProcess &gp, const vector<VectorXd> &points, const vector<double> &values,
+                             double best) {
+  size_t d = lower.size();
+  uniform_real_distribution<double> uniform(0, 1);
+  normal_distribution<double> normal(0, 1);
+  VectorXd proposal(d), candidate(d);
+  double largest = -1;
+  auto consider = [&]() {
+    double mean, deviation;
+    gp.predict(candidate, mean, deviation);
+    double improvement = expectedImprovement(mean, deviation, best);
+    if (improvement > largest) {
+      largest = improvement;
+      proposal = candidate;
+    }
+  };
+  // the best points so far, whose neighborhoods are searched at two scales
+  vector<size_t> order(values.size());
+  for (size_t i = 0; i < order.size(); i++) {
+    order[i] = i;
+  }
+  size_t neighborhoods = min((size_t)NEIGHBORHOODS, order.size());
+  partial_sort(order.begin(), order.begin() + neighborhoods, order.end(),
+               [&values](size_t a, size_t b) { return values[a] < values[b]; });
+  for (int i = 0; i < CANDIDATES; i++) {
+    for (size_t j = 0; j < d; j++) {
+      candidate[j] = uniform(generator);
+    }
+    consider();
+    if (neighborhoods > 0) {
+      const VectorXd &center = points[order[i % neighborhoods]];
+      double scale = i % 2 == 0? 0.1: 0.01;
+      for (size_t j = 0; j < d; j++) {
+        candidate[j] = fmin(fmax(center[j] + scale * normal(generator), 0.0), 1.0);
+      }
+      consider();
+    }
+  }
+  // refine the best candidate with shrinking perturbations
+  double scale = 0.01;
+  for (int i = 0; i < REFINEMENTS; i++, scale *= 0.93) {
+    VectorXd center = proposal;
+    for (size_t j = 0; j < d; j++) {
+      candidate[j] = fmin(fmax(center[j] + scale * normal(generator), 0.0), 1.0);
+    }
+    consider();
+  }
+  return proposal;
+}
+
+double BayesTuner::tune(Twiddle &model, VectorXd &p, const double target, const int steps, const double dt,
+                        int evaluations, vector<Twiddle::Pass> *passes) {
+  size_t d = lower.size();
+  VectorXd range = upper - lower;
+  // the points in the unit box, and the logarithms of their errors
+  vector<VectorXd> points;
+  vector<double> values;
+  GaussianProcess gp;
+  double best = INFINITY, least_error = INFINITY;
+  VectorXd best_p = lower;
+  size_t fitted = 0;
+  // the values above the median are regressed as the median, so that the runs far from the minimum
+  // do not take the variance of the regression from the differences near it
+  double cap = INFINITY;
+
+  // run a batch of points of the unit box, and add them to the regression
+  auto runPoints = [&](const vector<VectorXd> &batch_points) {
+    vector<VectorXd> ps;
+    for (size_t i = 0; i < batch_points.size(); i++) {
+      ps.push_back(lower + batch_points[i].cwiseProduct(range));
+    }
+    vector<double> errors = model.runBatch(ps, target, steps, dt);
+    for (size_t i = 0; i < errors.size(); i++) {
+      double value = logError(errors[i]);
+      points.push_back(batch_points[i]);
+      values.push_back(value);
+      gp.add(batch_points[i], fmin(value, cap));
+      if (errors[i] < least_error) {
+        least_error = errors[i];
+        best = value;
+        best_p = ps[i];
+      }
+    }
+    // cap the values at their median and refit the regression whenever the points double
+    if (points.size() >= 2 * fitted) {
+      vector<double> sorted(values);
+      nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+      cap = sorted[sorted.size() / 2];
+      gp = GaussianProcess();
+      for (size_t i = 0; i < points.size(); i++) {
+        gp.add(points[i], fmin(values[i], cap));
+      }
+      gp.fit();
+      fitted = points.size();
+    }
+    if (passes) {
+      passes->push_back(Twiddle::Pass{best_p, VectorXd::Zero(d), least_error});
+    }
+  };
+
+  // a Latin hypercube of a stratum per initial run on every coefficient
+  int initial = min(evaluations, max(batch, 2 * (int)d + 2));
+  vector<VectorXd> design(initial, VectorXd(d));
+  uniform_real_distribution<double> uniform(0, 1);
+  for (size_t j = 0; j < d; j++) {
+    vector<int> strata(initial);
+    for (int i = 0; i < initial; i++) {
+      strata[i] = i;
+    }
+    shuffle(strata.begin(), strata.end(), generator);
+    for (int i = 0; i < initial; i++) {
+      design[i][j] = (strata[i] + uniform(generator)) / initial;
+    }
+  }
+  runPoints(design);
+
+  while ((int)points.size() < evaluations) {
+    int size = min(batch, evaluations - (int)points.size());
+    vector<VectorXd> proposals;
+    size_t observed = gp.size();
+    for (int i = 0; i < size; i++) {
+      VectorXd x = propose(gp, points, values, best);
+      proposals.push_back(x);
+      if (i + 1 < size) {
+        // the next points of the batch take this one to be at its prediction
+        double mean, deviation;
+        gp.predict(x, mean, deviation);
+        gp.add(x, mean);
+      }
+    }
+    gp.truncate(observed);
+    runPoints(proposals);
+  }
+  this->evaluations = points.size();
+  p = best_p;
+  return least_error;
+}
@@ -0,0 +1,83 @@
+#ifndef _TUNE_BAYESTUNER_H_
+#define _TUNE_BAYESTUNER_H_
+
+#include <random>
+#include <vector>
+#include "Eigen/Dense"
+#include "GaussianProcess.h"
+#include "Twiddle.h"
+
+using namespace std;
+using Eigen::VectorXd;
+
+/**
+ * BayesTuner tunes the coefficients of a model within a box by Bayesian optimization: a Gaussian
+ * process regresses the logarithm of the error of the runs over the box, and the next runs are at
+ * the points of the largest expected improvement over the least error so far. The runs start with
+ * a Latin hypercube over the box, and go on in batches, which the model can run in parallel: the
+ * points of a batch are proposed one after another, each with the errors of the points before it
+ * taken to be their predictions, and the predictions are replaced by the errors of the runs. The
+ * logarithm makes the surrogate as fine near the minimum, where the errors are orders of
+ * magnitude apart, as far from it.
+ */
+class BayesTuner {
+  // the box of the coefficients
+  VectorXd lower;
+  VectorXd upper;
+  // number of runs of a batch
+  int batch;
+  // the generator of the initial runs and of the candidate points
+  default_random_engine generator;
+  // number of runs of the last tuning
+  int evaluations = 0;
+
+  /**
+   * Return the point of the largest expected improvement, in the unit box
+   * @param gp the regression of the logarithms of the errors
+   * @param points the points run so far, in the unit box
+   * @param values the logarithms of their errors
+   * @param best the least logarithm of the errors
+   */
+  VectorXd propose(const GaussianProcess &gp, const vector<VectorXd> &points, const vector<double> &values,
+                   double best);
+
+public:
+  /**
+   * Constructor
+   * @param lower the lower bounds of the coefficients
+   * @param upper the upper bounds of the coefficients
+   * @param batch number of runs of a batch
+   * @param seed the seed of the initial runs and of the candidate points
+   */
+  BayesTuner(const VectorXd &lower, const VectorXd &upper, int batch = 4, unsigned seed = 1);
+
+  /**
+   * Tune the coefficients
+   * @param model the model to run
+   * @param p receives the coefficients of the least error
+   * @param target the target value to reach
+   * @param steps the steps assumed for convergence
+   * @param dt the delta time for each step
+   * @param evaluations number of runs
+   * @param passes receives the coefficients and the least error after the initial runs and after
+   * every batch, with zero adjustments, to follow the convergence, default is not to record them
+   * @return the least error
+   */
+  double tune(Twiddle &model, VectorXd &p, const double target, const int steps, const double dt,
+              int evaluations, vector<Twiddle::Pass> *passes = NULL);
+
+  /**
+   * Return the number of runs of the last tuning
+   */
+  int getEvaluations() const { return evaluations; }
+
+  /**
+   * Return the expected improvement of a value over the least value, for minimization
+   * @param mean the mean of the value
+   * @param deviation the standard deviation of the value
+   * @param best the least value
+   */
+  static double expectedImprovement(double mean, double deviation, double best);
+};
+
+#endif
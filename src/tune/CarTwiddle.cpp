@@ -5,21 +5,9 @@
 using namespace std;
 using Eigen::VectorXd;
 
-default_random_engine CarTwiddle::generator;
-
-double normalizeAngle(double a) {
-  while (a >= M_PI) a -= 2. * M_PI;
-  while (a < -M_PI) a += 2. * M_PI;
-  return a;
-}
-
 CarTwiddle::CarTwiddle(double length, double x, double y, double yaw,
-                       double velocity, double noise[2], double steering_drift) {
-  this->length = length;
-  this->x = x;
-  this->y = y;
-  this->yaw = yaw;
-  this->velocity = velocity;
+                       double velocity, double noise[2], double steering_drift):
+    vehicle(length, x, y, yaw, velocity) {
   this->noise[0] = noise[0];
   this->noise[1] = noise[1];
   this->steering_drift = steering_drift;
@@ -27,7 +15,7 @@ CarTwiddle::CarTwiddle(double length, double x, double y, double yaw,
   rand_yawd = normal_distribution<double>(0, noise[1]);
 }
 
-CarTwiddle::CarTwiddle(CarTwiddle &another) {
+CarTwiddle::CarTwiddle(const CarTwiddle &another) {
   *this = another;
 }
 
@@ -36,99 +24,191 @@ CarTwiddle::CarTwiddle(CarTwiddle *another) {
 }
 
 CarTwiddle& CarTwiddle::operator=(const CarTwiddle &another) {
-  length = another.length;
-  x = another.x;
-  y = another.y;
-  yaw = another.yaw;
-  velocity = another.velocity;
+  vehicle = another.vehicle;
   noise[0] = another.noise[0];
   noise[1] = another.noise[1];
   steering_drift = another.steering_drift;
+  track = another.track;
+  track_hint = another.track_hint;
+  position = another.position;
+  mode = another.mode;
+  dt_jitter = another.dt_jitter;
+  timed = another.timed;
+  timed_pid = another.timed_pid;
+  timed_speed_pid = another.timed_speed_pid;
+  seed = another.seed;
+  common_noise = another.common_noise;
+  batched_noise = another.batched_noise;
+  noise_buffer = another.noise_buffer;
   rand_a = normal_distribution<double>(0, noise[0]);
   rand_yawd = normal_distribution<double>(0, noise[1]);
   return *this;
 }
 
+void CarTwiddle::setSeed(unsigned seed) {
+  this->seed = seed;
+  generator.seed(seed);
+  jitter_generator.seed(jitterSeed(seed));
+  normal_generator.seed(seed);
+  noise_buffer.reset();
+}
+
+void CarTwiddle::setCommonNoise(bool common) {
+  common_noise = common;
+}
+
+void CarTwiddle::setBatchedNoise(bool batched) {
+  batched_noise = batched;
+  normal_generator.seed(seed);
+  noise_buffer.reset();
+}
+
+void CarTwiddle::generateNoise(int steps) {
+  default_random_engine noise_generator(seed), jitter_noise_generator(jitterSeed(seed));
+  normal_distribution<double> noise_a(0, noise[0]);
+  normal_distribution<double> noise_yawd(0, noise[1]);
+  uniform_real_distribution<double> jitter(-dt_jitter, dt_jitter);
+  vector<double> *buffer = new vector<double>(3 * steps);
+  // the standard variates of the batched noise in the order of the steps, drawn a block at once
+  vector<double> normals(batched_noise? 2 * steps: 0);
+  if (batched_noise) {
+    NormalGenerator(seed).fill(normals.data(), normals.size());
+  }
+  for (int i = 0; i < steps; i++) {
+    (*buffer)[3 * i] = dt_jitter > 0? jitter(jitter_noise_generator): 0;
+    if (batched_noise) {
+      (*buffer)[3 * i + 1] = noise[0] * normals[2 * i];
+      (*buffer)[3 * i + 2] = noise[1] * normals[2 * i + 1];
+    } else {
+      (*buffer)[3 * i + 1] = noise_a(noise_generator);
+      (*buffer)[3 * i + 2] = noise_yawd(noise_generator);
+    }
+  }
+  noise_buffer.reset(buffer);
+}
+
+void CarTwiddle::setSteeringDrift(double drift) {
+  steering_drift = drift;
+}
+
 void CarTwiddle::setMode(int mode) {
-  assert(mode ==1 || mode == 2);
+  assert(mode == STEERING_MODE || mode == ACCELERATION_MODE || mode == JOINT_MODE);
   this->mode = mode;
 }
 
+void CarTwiddle::setDtJitter(double jitter) {
+  assert(jitter >= 0 && jitter < 1);
+  dt_jitter = jitter;
+  noise_buffer.reset();
+}
+
+void CarTwiddle::setTrack(const Track *track) {
+  this->track = track;
+  track_hint = -1;
+  if (track) {
+    position = track->locate(vehicle.getX(), vehicle.getY(), track_hint);
+  }
+}
+
+void CarTwiddle::setTimedControl(bool timed, double tau, double windup) {
+  this->timed = timed;
+  timed_pid.setDerivativeFilter(tau);
+  timed_pid.setIntegralLimit(windup);
+  timed_speed_pid.setDerivativeFilter(tau);
+  timed_speed_pid.setIntegralLimit(windup);
+}
+
 // Implements a simple car motion model
 void CarTwiddle::move(double dt, double steering, double acceleration) {
   // perturb the acceleration and steering angle with gaussian noise
-  acceleration += rand_a(generator);
-  steering += rand_yawd(generator) + steering_drift;
-  
-  // clamp the steering angle
-  if (steering > max_steering) steering = max_steering;
-  if (steering < -max_steering) steering = -max_steering;
-
-  if (acceleration > max_acceleration) acceleration = max_acceleration;
-  if (acceleration < max_deceleration) acceleration = max_deceleration;
-
-  double dist = (velocity + acceleration * dt / 2) * dt;
-  // Compute turing angle from steering angle
-  double turn = tan(steering) * dist / length;
-  double new_yaw = normalizeAngle(yaw + turn);
-
-  if (fabs(turn) > EPSILON) {  // turn is not 0
-    // Compute the turn radius
-    double radius = dist / turn; // del psi = turn / dt
-    // update x and y
-    x += radius * (sin(new_yaw) - sin(yaw));
-    y += radius * (cos(yaw) - cos(new_yaw));
-
-  #ifdef VERBOSE_OUT
-    cout << "Move: " << turn << " " << yaw << " " << new_yaw << " " << dist << " " << steering 
-         << " " << radius <<  " " << acceleration << " " << velocity << endl;
-  #endif
-  } else {  // turn is 0
-    // update x and y
-    x += dist * cos(yaw);
-    y += dist * sin(yaw);
+  if (batched_noise) {
+    acceleration += normal_generator(noise[0]);
+    steering += normal_generator(noise[1]) + steering_drift;
+  } else {
+    acceleration += rand_a(generator);
+    steering += rand_yawd(generator) + steering_drift;
   }
+  step(dt, steering, acceleration);
+}
 
-  // update velocity
-  velocity += acceleration * dt;
-  if (velocity > max_velocity) velocity = max_velocity;
-  // update yaw
-  yaw = new_yaw;
+void CarTwiddle::step(double dt, double steering, double acceleration) {
+  vehicle.move(dt, steering, acceleration);
+  if (track) {
+    // the car moves a few segments per step, so the last nearest segment is a close hint
+    position = track->locate(vehicle.getX(), vehicle.getY(), track_hint);
+  }
 }
 
 double CarTwiddle::run(const VectorXd &p, const double target, const int steps, const double dt,
-        vector<double> *x_trajectory, vector<double> *y_trajectory) {
+        TrajectorySink *trajectory) {
+  if (common_noise && (!noise_buffer || (int)noise_buffer->size() != 3 * 2 * steps)) {
+    generateNoise(2 * steps);
+  }
+  // the noise to replay, NULL to draw new noise
+  const double *replay = common_noise? noise_buffer->data(): NULL;
   // Backup the original settings
   CarTwiddle origin(*this);
-  // Initialize PID
+  // Initialize PID, the steering of the joint mode keeps the car on the line or the track
+  bool joint = mode == JOINT_MODE;
   pid.init(p[0], p[1], p[2]);
-  pid.setTarget(target);
+  pid.setTarget(joint? 0: target);
+  timed_pid.init(p[0], p[1], p[2]);
+  timed_pid.setTarget(joint? 0: target);
+  timed_pid.setNominalDt(dt);
+  if (joint) {
+    speed_pid.init(p[3], p[4], p[5]);
+    speed_pid.setTarget(target);
+    timed_speed_pid.init(p[3], p[4], p[5]);
+    timed_speed_pid.setTarget(target);
+    timed_speed_pid.setNominalDt(dt);
+  }
+  uniform_real_distribution<double> jitter(-dt_jitter, dt_jitter);
   double error = 0;
 #ifdef VERBOSE_OUT
   cout << "Coeff: " << p[0] << " " << p[1] << " " << p[2] << endl;
 #endif
+  if (trajectory) {
+    trajectory->begin(2 * steps);
+  }
   for (int i = 0; i < 2 * steps; i++) {
-      double err = pid.getError();
+      double err = timed? timed_pid.getError(): pid.getError();
       if (i >= steps) { // compute squared sum of error
         error += err*err;
+        if (joint) {
+          double speed_err = timed? timed_speed_pid.getError(): speed_pid.getError();
+          error += speed_err * speed_err;
+        }
+      }
+      // the delta time of this step, and the control measured it
+      double step_dt = dt;
+      if (dt_jitter > 0) {
+        step_dt = dt * (1 + (replay? replay[3 * i]: jitter(jitter_generator)));
+      }
+      // update PID value, and get new PID control value
+      double value = mode == ACCELERATION_MODE? vehicle.getVelocity(): -getCte();
+      double control = timed? timed_pid.updateValue(value, step_dt): pid.updateValue(value);
+      double steering = mode == ACCELERATION_MODE? 0: control;
+      double acceleration = mode == STEERING_MODE? 0: control;
+      if (joint) {
+        double velocity = vehicle.getVelocity();
+        acceleration = timed? timed_speed_pid.updateValue(velocity, step_dt): speed_pid.updateValue(velocity);
       }
-      // update PID value
-      pid.updateValue(mode == STEERING_MODE? y: velocity);
-      // Get new PID control value
-      double control = pid.getControl();
       // Apply control value to move the car
-      mode == STEERING_MODE? move(dt, control, 0): move(dt, 0, control);
-      if (x_trajectory) {
-        x_trajectory->push_back(x);
+      if (replay) {
+        step(step_dt, steering + (replay[3 * i + 2] + steering_drift), acceleration + replay[3 * i + 1]);
+      } else {
+        move(step_dt, steering, acceleration);
       }
-      if (y_trajectory) {
-        y_trajectory->push_back(y);
+      if (trajectory) {
+        TrajectoryPoint point = {vehicle.getX(), vehicle.getY(), vehicle.getYaw(), vehicle.getVelocity(), control,
+                                 timed? timed_pid.getError(): pid.getError()};
+        trajectory->record(point);
       }
 #ifdef VERBOSE_OUT
       if (i <= steps) {
-        cout << "Car moved with PID: " << control << ", " << x << " " << y << " " << yaw << " " << velocity << endl;
+        cout << "Car moved with PID: " << control << ", " << vehicle.getX() << " " << vehicle.getY() << " " << vehicle.getYaw() << " " << vehicle.getVelocity() << endl;
       } else {
-        cout << "Car moved with PID: " << control << ", " << x << " " << y << " " << yaw << " " << velocity 
+        cout << "Car moved with PID: " << control << ", " << vehicle.getX() << " " << vehicle.getY() << " " << vehicle.getYaw() << " " << vehicle.getVelocity() 
              << " " << error / (i - steps) << endl;
       }
 #endif
@@ -137,7 +217,104 @@ double CarTwiddle::run(const VectorXd &p, const double target, const int steps,
   *this = origin;
   error /= steps;
 #ifdef VERBOSE_OUT
-  cout << "Car out: " << x << " " << y << " " << yaw << " " << velocity << endl;
+  cout << "Car out: " << vehicle.getX() << " " << vehicle.getY() << " " << vehicle.getYaw() << " " << vehicle.getVelocity() << endl;
 #endif
   return error;
-}
\ No newline at end of file
+}
+
+double CarTwiddle::runGradient(const VectorXd &p, const double target, const int steps, const double dt,
+                               VectorXd &gradient) {
+  return mode == JOINT_MODE? runDual<6>(p, target, steps, dt, gradient): runDual<3>(p, target, steps, dt, gradient);
+}
+
+template<int N> double CarTwiddle::runDual(const VectorXd &p, const double target, const int steps, const double dt,
+                                           VectorXd &gradient) {
+  typedef Dual<N> Scalar;
+  if (common_noise && (!noise_buffer || (int)noise_buffer->size() != 3 * 2 * steps)) {
+    generateNoise(2 * steps);
+  }
+  const double *replay = common_noise? noise_buffer->data(): NULL;
+  // the PID and the state of the car on dual numbers, the car itself is not moved
+  PIDController<Scalar> dual_pid;
+  TimedPIDController<Scalar> dual_timed_pid;
+  dual_pid.init(Scalar::variable(p[0], 0), Scalar::variable(p[1], 1), Scalar::variable(p[2], 2));
+  dual_pid.setTarget(target);
+  dual_timed_pid.init(Scalar::variable(p[0], 0), Scalar::variable(p[1], 1), Scalar::variable(p[2], 2));
+  dual_timed_pid.setTarget(target);
+  dual_timed_pid.setNominalDt(dt);
+  dual_timed_pid.setDerivativeFilter(timed_pid.getDerivativeFilter());
+  dual_timed_pid.setIntegralLimit(timed_pid.getIntegralLimit());
+  bool joint = mode == JOINT_MODE;
+  PIDController<Scalar> dual_speed_pid;
+  TimedPIDController<Scalar> dual_timed_speed_pid;
+  if (joint) {
+    dual_pid.setTarget(0);
+    dual_timed_pid.setTarget(0);
+    dual_speed_pid.init(Scalar::variable(p[3], 3), Scalar::variable(p[4], 4), Scalar::variable(p[5], 5));
+    dual_speed_pid.setTarget(target);
+    dual_timed_speed_pid.init(Scalar::variable(p[3], 3), Scalar::variable(p[4], 4), Scalar::variable(p[5], 5));
+    dual_timed_speed_pid.setTarget(target);
+    dual_timed_speed_pid.setNominalDt(dt);
+    dual_timed_speed_pid.setDerivativeFilter(timed_speed_pid.getDerivativeFilter());
+    dual_timed_speed_pid.setIntegralLimit(timed_speed_pid.getIntegralLimit());
+  }
+  Scalar x = vehicle.getX(), y = vehicle.getY(), yaw = vehicle.getYaw(), velocity = vehicle.getVelocity();
+  TrackPosition dual_position = position;
+  int hint = track_hint;
+  uniform_real_distribution<double> jitter(-dt_jitter, dt_jitter);
+  Scalar error = 0;
+  for (int i = 0; i < 2 * steps; i++) {
+    Scalar err = timed? dual_timed_pid.getError(): dual_pid.getError();
+    if (i >= steps) {
+      error += err * err;
+      if (joint) {
+        Scalar speed_err = timed? dual_timed_speed_pid.getError(): dual_speed_pid.getError();
+        error += speed_err * speed_err;
+      }
+    }
+    double step_dt = dt;
+    if (dt_jitter > 0) {
+      step_dt = dt * (1 + (replay? replay[3 * i]: jitter(jitter_generator)));
+    }
+    Scalar value;
+    if (mode != ACCELERATION_MODE) {
+      if (track) {
+        // the cross track error changes with the position across the direction of the track
+        value = -(dual_position.cte + (x - x.value) * sin(dual_position.heading) - (y - y.value) * cos(dual_position.heading));
+      } else {
+        value = y;
+      }
+    } else {
+      value = velocity;
+    }
+    Scalar control = timed? dual_timed_pid.updateValue(value, step_dt): dual_pid.updateValue(value);
+    Scalar steering = mode == ACCELERATION_MODE? 0: control;
+    Scalar acceleration = mode == STEERING_MODE? 0: control;
+    if (joint) {
+      acceleration = timed? dual_timed_speed_pid.updateValue(velocity, step_dt): dual_speed_pid.updateValue(velocity);
+    }
+    if (replay) {
+      steering += replay[3 * i + 2] + steering_drift;
+      acceleration += replay[3 * i + 1];
+    } else if (batched_noise) {
+      acceleration += normal_generator(noise[0]);
+      steering += normal_generator(noise[1]) + steering_drift;
+    } else {
+      acceleration += rand_a(generator);
+      steering += rand_yawd(generator) + steering_drift;
+    }
+    vehicle.moveArc(x, y, yaw, velocity, step_dt, steering, acceleration);
+    if (track) {
+      dual_position = track->locate(x.value, y.value, hint);
+    }
+  }
+  // as after run, the next run draws new pairs of normal variates
+  rand_a = normal_distribution<double>(0, noise[0]);
+  rand_yawd = normal_distribution<double>(0, noise[1]);
+  error /= steps;
+  gradient.resize(N);
+  for (int k = 0; k < N; k++) {
+    gradient[k] = error.partials[k];
+  }
+  return error.value;
+}
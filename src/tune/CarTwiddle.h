@@ -2,38 +2,96 @@
 #define _TUNE_CARTWIDDLE_H_
 
 #include <math.h>
+#include <memory>
 #include <random>
+#include <vector>
 #include "Eigen/Dense"
 #include "Twiddle.h"
-#include "../control/PID.h"
-
-#define EPSILON 1E-6
+#include "../control/PIDController.h"
+#include "../control/TimedPIDController.h"
+#include "../sim/Track.h"
+#include "../sim/Vehicle.h"
+#include "../utils/Dual.h"
+#include "../utils/NormalGenerator.h"
 
 class CarTwiddle: public Twiddle {
 public:
   const int STEERING_MODE = 1;
   const int ACCELERATION_MODE = 2;
+  // steering and acceleration at once, with the steering coefficients followed by the acceleration
+  // coefficients
+  const int JOINT_MODE = 3;
 
 private:
-  static std::default_random_engine generator;
-  
-  double length;
-  double x, y;
-  double yaw;
-  double velocity;
+  // the random number generator of this car, so that cars can run on parallel threads
+  std::default_random_engine generator;
+  // the seed of the generator
+  unsigned seed = std::default_random_engine::default_seed;
+  // the random number generator of the delta time jitter, a stream of its own so that the noise
+  // of a seed is the same with and without jitter
+  std::default_random_engine jitter_generator{jitterSeed(std::default_random_engine::default_seed)};
+
+  // true to draw the noise from the batched normal generator instead of the normal distributions
+  bool batched_noise = false;
+  // the batched normal generator of the noise, seeded with the seed
+  NormalGenerator normal_generator{std::default_random_engine::default_seed};
+
+  // the kinematic model of the car
+  Vehicle vehicle;
   double noise[2];
   double steering_drift;
-  double max_steering = M_PI/ 6.667;
-  double max_acceleration = 8;
-  double max_deceleration = -20;
-  double max_velocity = 100;
   int mode = STEERING_MODE;
+  // relative jitter of the delta time of every step
+  double dt_jitter = 0;
+  // true to control with the time aware PID
+  bool timed = false;
+  // the track to follow in the steering mode, NULL to follow the x axis
+  const Track *track = NULL;
+  // the nearest segment of the track in the last step
+  int track_hint = -1;
+  // the position of the car relative to the track
+  TrackPosition position;
+  // true to replay the same noise in every run
+  bool common_noise = false;
+  // the delta time jitter, acceleration noise and steering noise of every step of the replayed
+  // noise, shared by the copies of the car
+  std::shared_ptr<const std::vector<double> > noise_buffer;
 
-  PID pid;
+  PIDController<double> pid;
+  TimedPIDController<double> timed_pid;
+  // the speed PIDs of the joint mode, in which pid and timed_pid steer
+  PIDController<double> speed_pid;
+  TimedPIDController<double> timed_speed_pid;
 
   // Random distributions
   std::normal_distribution<double> rand_a;
   std::normal_distribution<double> rand_yawd;
+
+  /**
+   * Return the seed of the jitter generator of a seed
+   */
+  static unsigned jitterSeed(unsigned seed) { return seed ^ 0x5bd1e995u; }
+
+  /**
+   * Draw the noise of every step of a run from a generator seeded with the seed, in the order a
+   * run draws it, to replay in every run
+   * @param steps number of steps of a run
+   */
+  void generateNoise(int steps);
+
+  /**
+   * Move the car without noise, and locate it on the track
+   * @param dt the time to move
+   * @param steering the steering angle
+   * @param acceleration the acceleration
+   */
+  void step(double dt, double steering, double acceleration);
+
+  /**
+   * Run the car on dual numbers of N variables, the coefficients, see runGradient
+   */
+  template<int N> double runDual(const VectorXd &p, const double target, const int steps, const double dt,
+                                 VectorXd &gradient);
 public:
   /**
    * Cconstructor
@@ -51,7 +109,7 @@ public:
    * Copy constructor
    * @param another reference to another CarTwiddle to copy from
    */ 
-  CarTwiddle(CarTwiddle &another);
+  CarTwiddle(const CarTwiddle &another);
 
   /**
    * Copy constructor
@@ -65,24 +123,158 @@ public:
    */ 
   CarTwiddle& operator=(const CarTwiddle &another);
 
+  /**
+   * Seed the random number generators of the noise and of the delta time jitter
+   * @param seed the seed
+   */
+  void setSeed(unsigned seed);
+
+  /**
+   * Return the seed of the random number generator
+   */
+  unsigned getSeed() const { return seed; }
+
+  /**
+   * Replay the same noise in every run, common random numbers, so that the errors of different
+   * coefficient vectors differ by the coefficients rather than by the luck of the noise. The noise
+   * of every step is drawn once from a generator seeded with the seed, and it is the noise a run
+   * would draw right after seeding. Without it every run draws new noise from the generator
+   * @param common true to replay the same noise, false to draw new noise in every run
+   */
+  void setCommonNoise(bool common);
+
+  /**
+   * Return true if every run replays the same noise
+   */
+  bool getCommonNoise() const { return common_noise; }
+
+  /**
+   * Draw the noise from a NormalGenerator instead of the normal distributions, in every step and in
+   * the replayed noise. Its variates are drawn in vectorized blocks without rejections, but they are
+   * not those of the normal distributions, which stay the default so that the runs of a seed are
+   * reproducible
+   * @param batched true to draw the noise from the NormalGenerator
+   */
+  void setBatchedNoise(bool batched);
+
+  /**
+   * Return true if the noise is drawn from the NormalGenerator
+   */
+  bool getBatchedNoise() const { return batched_noise; }
+
+  /**
+   * Write the state of the random number generators, the NormalGenerator of the batched noise is
+   * not written
+   * @param out the stream to write to
+   */
+  void saveState(ostream &out) const { out << generator << endl << jitter_generator << endl; }
+
+  /**
+   * Read the state of the random number generators
+   * @param in the stream to read from
+   */
+  bool loadState(istream &in) {
+    // the generators are read without skipping white space
+    return bool(in >> ws >> generator >> ws >> jitter_generator);
+  }
+
+  /**
+   * Move the car with the fast approximations of the kinematic model instead of the math library
+   * @param fast true for the fast approximations
+   */
+  void setFastMath(bool fast) { vehicle.setFastMath(fast); }
+
+  /**
+   * Set the integrator of the kinematic model
+   * @param integrator Vehicle::ARC_INTEGRATOR, Vehicle::RK4_INTEGRATOR or Vehicle::ADAPTIVE_INTEGRATOR
+   */
+  void setIntegrator(int integrator) { vehicle.setIntegrator(integrator); }
+
+  /**
+   * Set the steering drift
+   * @param drift the drift added to every steering angle
+   */
+  void setSteeringDrift(double drift);
+
+  /**
+   * Return the steering drift
+   */
+  double getSteeringDrift() const { return steering_drift; }
+
   /**
    * Set the simulation mode, can be:
-   * STEERING_MODE or ACCELERATION_MODE
+   * STEERING_MODE, ACCELERATION_MODE or JOINT_MODE. The joint mode steers the car along the line
+   * or the track, and accelerates it to the target speed, with 6 coefficients, and its error is
+   * the sum of the mean squared cross track error and the mean squared speed error
    */
   void setMode(int mode);
 
+  /**
+   * Return the simulation mode
+   */
+  int getMode() const { return mode; }
+
+  /**
+   * Jitter the delta time of every simulated step to simulate irregular control cadence. The delta
+   * time of a step is drawn uniformly from [dt * (1 - jitter), dt * (1 + jitter)]
+   * @param jitter the relative jitter in [0, 1), 0 for fixed delta time
+   */
+  void setDtJitter(double jitter);
+
+  /**
+   * Control the car with the time aware PID, which is given the delta time of every step
+   * @param timed true to use the time aware PID, false to use the fixed cadence PID
+   * @param tau time constant of the derivative filter, 0 for no filtering
+   * @param windup the anti-windup limit of the integral, 0 for no limit
+   */
+  void setTimedControl(bool timed, double tau = 0, double windup = 0);
+
+  /**
+   * Follow a track in the steering mode instead of the x axis. The error of the steering PID is
+   * the distance of the car to the left of the track, which the car takes as the y coordinate
+   * when following the x axis
+   * @param track the track, NULL to follow the x axis. It must outlive the car
+   */
+  void setTrack(const Track *track);
+
+  /**
+   * Return the cross track error of the car, positive on the right side of the track
+   */
+  double getCte() const { return track? position.cte: -vehicle.getY(); }
+
+  /**
+   * Return the heading error of the car, positive if the car points to the left of the track
+   */
+  double getHeadingError() const { return track? position.headingError(vehicle.getYaw()): vehicle.getYaw(); }
+
   /**
    * Move the car
    * @param dt the time to move
    * @param steering the steering angle
    * @param acceleration the acceleration
-   * @param x_trajectory store the x trajectory, default is not to store the trajectory
-   * @param y_trajectory store the y trajectory, default is not to store the trajectory
    */ 
   virtual void move(double dt, double steering, double acceleration = 0);
 
+  /**
+   * Run the car for 2 * steps steps, and return the mean squared error of the last steps
+   * @param trajectory receives the position, yaw, velocity, control and error of every step, NULL
+   * to record nothing. The control and the error of the joint mode are those of the steering
+   */
   double run(const Eigen::VectorXd &t, const double target, const int steps, const double dt,
-              vector<double> *x_trajectory, vector<double> *y_trajectory);
+              TrajectorySink *trajectory);
+
+  /**
+   * Run the car on dual numbers, and return the mean squared error of the last steps and its
+   * gradient with respect to the coefficients, in one run. The run draws the same noise as run, and
+   * moves the car along the exact arc, which the fast approximations and the integrators
+   * approximate, so its error is that of run without them
+   * @param p the coefficients
+   * @param target the target value to reach
+   * @param steps the steps required to reach a convergence
+   * @param dt the delta time for each step
+   * @param gradient receives the gradient of the error with respect to the coefficients
+   */
+  double runGradient(const VectorXd &p, const double target, const int steps, const double dt, VectorXd &gradient);
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,124 @@
+#include <iostream>
+#include "Coordinator.h"
+
+Coordinator::Coordinator(uint64_t options): options(options), workers(0), stopping(false) {}
+
+Coordinator::~Coordinator() {
+  {
+    lock_guard<mutex> guard(lock);
+    stopping = true;
+  }
+  queued.notify_all();
+  listener.shutdown();
+  if (acceptor.joinable()) {
+    acceptor.join();
+  }
+  {
+    // no more workers are accepted, and the workers waiting for a result are woken up
+    lock_guard<mutex> guard(lock);
+    for (list<Socket>::iterator it = connections.begin(); it != connections.end(); ++it) {
+      it->shutdown();
+    }
+  }
+  for (size_t i = 0; i < servers.size(); i++) {
+    servers[i].join();
+  }
+}
+
+bool Coordinator::listen(const string &address) {
+  if (!listener.listen(address)) {
+    return false;
+  }
+  acceptor = thread(&Coordinator::accept, this);
+  return true;
+}
+
+size_t Coordinator::getWorkers() {
+  lock_guard<mutex> guard(lock);
+  return workers;
+}
+
+void Coordinator::accept() {
+  while (true) {
+    Socket client;
+    if (!listener.accept(client)) {
+      return;
+    }
+    lock_guard<mutex> guard(lock);
+    if (stopping) {
+      return;
+    }
+    connections.push_back(move(client));
+    servers.push_back(thread(&Coordinator::serve, this, &connections.back()));
+  }
+}
+
+void Coordinator::serve(Socket *socket) {
+  // the worker is told the options of the coordinator, so that it stops when they are not its own
+  uint64_t worker_options;
+  bool matching = receiveOptions(*socket, worker_options) && sendOptions(*socket, options);
+  if (matching && worker_options != options) {
+    std::cerr << "Rejected a worker building its cars with other options" << std::endl;
+    matching = false;
+  }
+  if (!matching) {
+    lock_guard<mutex> guard(lock);
+    socket->shutdown();
+    return;
+  }
+  {
+    lock_guard<mutex> guard(lock);
+    workers++;
+  }
+  while (true) {
+    Task *task;
+    {
+      unique_lock<mutex> guard(lock);
+      queued.wait(guard, [this]() { return stopping || !queue.empty(); });
+      if (stopping) {
+        break;
+      }
+      task = queue.front();
+      queue.pop_front();
+    }
+    uint64_t id = (uint64_t)(uintptr_t)task, received;
+    double error;
+    if (!sendJob(*socket, id, task->job) || !receiveResult(*socket, received, error) || received != id) {
+      // another worker takes the job
+      lock_guard<mutex> guard(lock);
+      queue.push_front(task);
+      queued.notify_one();
+      break;
+    }
+    lock_guard<mutex> guard(lock);
+    task->error = error;
+    task->done = true;
+    done.notify_all();
+  }
+  lock_guard<mutex> guard(lock);
+  workers--;
+  socket->shutdown();
+}
+
+double Coordinator::evaluate(const EvaluationJob &job) {
+  return evaluate(vector<EvaluationJob>(1, job))[0];
+}
+
+vector<double> Coordinator::evaluate(const vector<EvaluationJob> &jobs) {
+  vector<Task> tasks(jobs.size());
+  unique_lock<mutex> guard(lock);
+  for (size_t i = 0; i < jobs.size(); i++) {
+    tasks[i].job = jobs[i];
+    tasks[i].done = false;
+    queue.push_back(&tasks[i]);
+  }
+  queued.notify_all();
+  for (size_t i = 0; i < tasks.size(); i++) {
+    done.wait(guard, [&tasks, i]() { return tasks[i].done; });
+  }
+  vector<double> errors(jobs.size());
+  for (size_t i = 0; i < tasks.size(); i++) {
+    errors[i] = tasks[i].error;
+  }
+  return errors;
+}
@@ -0,0 +1,111 @@
+#ifndef _TUNE_COORDINATOR_H_
+#define _TUNE_COORDINATOR_H_
+
+#include <stdint.h>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "EvaluationJob.h"
+#include "../utils/Socket.h"
+
+using namespace std;
+
+/**
+ * Coordinator hands out evaluation jobs to worker processes, on this machine or others, and
+ * collects their errors. Workers connect to the address the coordinator listens on at any time,
+ * and every worker is served by a thread of its own, which sends it a job from the queue, waits
+ * for the error, and takes the next job. The jobs of a worker that disconnects before sending the
+ * error of a job are queued again, so the evaluations go on as long as a worker is connected.
+ * A worker is served only if it builds its cars with the options of the coordinator.
+ * Evaluations can be requested from several threads at once.
+ */
+class Coordinator {
+  /**
+   * A job waiting for its error
+   */
+  struct Task {
+    EvaluationJob job;  // the job
+    double error;       // the error of the job
+    bool done;          // true if the error is in
+  };
+
+  // the hash of the options the cars are built with
+  uint64_t options;
+  // the listening socket
+  Socket listener;
+  // the thread accepting the workers
+  thread acceptor;
+  // the connections of the workers, and the threads serving them
+  list<Socket> connections;
+  vector<thread> servers;
+  // guards the queue, the tasks and the connections
+  mutex lock;
+  // signaled when a task is queued, or the coordinator is stopping
+  condition_variable queued;
+  // signaled when a task is done
+  condition_variable done;
+  // the tasks waiting for a worker
+  deque<Task *> queue;
+  // number of connected workers with the options
+  size_t workers;
+  // true if the coordinator is stopping
+  bool stopping;
+
+  /**
+   * Accept workers until the coordinator stops
+   */
+  void accept();
+
+  /**
+   * Serve a worker until it disconnects or the coordinator stops
+   * @param socket the connection to the worker
+   */
+  void serve(Socket *socket);
+
+public:
+  /**
+   * Constructor
+   * @param options the hash of the options the cars are built with, which the workers must match
+   */
+  explicit Coordinator(uint64_t options);
+
+  /**
+   * Destructor, disconnects the workers
+   */
+  ~Coordinator();
+
+  Coordinator(const Coordinator &) = delete;
+  Coordinator &operator=(const Coordinator &) = delete;
+
+  /**
+   * Listen for workers
+   * @param address unix:path or host:port
+   * @return true if successful
+   */
+  bool listen(const string &address);
+
+  /**
+   * Return the number of connected workers
+   */
+  size_t getWorkers();
+
+  /**
+   * Evaluate a job, waiting for a worker if none is connected
+   * @param job the job
+   * @return the error of the job
+   */
+  double evaluate(const EvaluationJob &job);
+
+  /**
+   * Evaluate jobs on as many workers as are free
+   * @param jobs the jobs
+   * @return the errors of the jobs
+   */
+  vector<double> evaluate(const vector<EvaluationJob> &jobs);
+};
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef _TUNE_EVALUATIONJOB_H_
+#define _TUNE_EVALUATIONJOB_H_
+
+#include <stdint.h>
+#include <string.h>
+#include "Eigen/Dense"
+#include "../utils/Socket.h"
+
+using Eigen::VectorXd;
+
+/**
+ * A run of the car of a speed bucket with a coefficient vector, evaluated by a worker
+ */
+struct EvaluationJob {
+  int32_t mode;    // STEERING_MODE, ACCELERATION_MODE or JOINT_MODE
+  int32_t speed;   // the speed bucket in mph
+  double target;   // the target value to reach
+  int32_t steps;   // the steps assumed for convergence
+  double dt;       // the delta time of a step
+  uint32_t seed;   // the seed of the noise replayed in the run
+  VectorXd p;      // the coefficients
+};
+
+// The messages between a coordinator and its workers, in the native layout of the machines, which
+// must be alike. A job is its id, the fields in order, the number of coefficients and the
+// coefficients. A result is the id of the job and the error of the run. A worker first sends the
+// hash of the options it builds its cars with, and the coordinator answers with the hash of its own,
+// as the jobs do not carry them, so that a worker with other options is not sent any jobs.
+
+// the most coefficients of a job
+#define EVALUATION_MAX_COEFFICIENTS 64
+
+/**
+ * Send the hash of the options the cars are built with
+ * @param socket the connection to the coordinator or the worker
+ * @param options the hash of the options
+ * @return true if successful
+ */
+inline bool sendOptions(Socket &socket, uint64_t options) {
+  return socket.send(&options, sizeof(options));
+}
+
+/**
+ * Receive the hash of the options the cars are built with
+ * @param socket the connection to the coordinator or the worker
+ * @param options receives the hash of the options
+ * @return true if successful, false if the connection is closed
+ */
+inline bool receiveOptions(Socket &socket, uint64_t &options) {
+  return socket.receive(&options, sizeof(options));
+}
+
+/**
+ * Send a job
+ * @param socket the connection to the worker
+ * @param id the id of the job
+ * @param job the job
+ * @return true if successful
+ */
+inline bool sendJob(Socket &socket, uint64_t id, const EvaluationJob &job) {
+  char message[8 + 4 + 4 + 8 + 4 + 8 + 4 + 4 + EVALUATION_MAX_COEFFICIENTS * 8];
+  uint32_t n = job.p.size();
+  if (n > EVALUATION_MAX_COEFFICIENTS) {
+    return false;
+  }
+  char *m = message;
+  memcpy(m, &id, 8); m += 8;
+  memcpy(m, &job.mode, 4); m += 4;
+  memcpy(m, &job.speed, 4); m += 4;
+  memcpy(m, &job.target, 8); m += 8;
+  memcpy(m, &job.steps, 4); m += 4;
+  memcpy(m, &job.dt, 8); m += 8;
+  memcpy(m, &job.seed, 4); m += 4;
+  memcpy(m, &n, 4); m += 4;
+  memcpy(m, job.p.data(), n * 8); m += n * 8;
+  return socket.send(message, m - message);
+}
+
+/**
+ * Receive a job
+ * @param socket the connection to the coordinator
+ * @param id receives the id of the job
+ * @param job receives the job
+ * @return true if successful, false if the connection is closed
+ */
+inline bool receiveJob(Socket &socket, uint64_t &id, EvaluationJob &job) {
+  char header[8 + 4 + 4 + 8 + 4 + 8 + 4 + 4];
+  if (!socket.receive(header, sizeof(header))) {
+    return false;
+  }
+  const char *m = header;
+  uint32_t n;
+  memcpy(&id, m, 8); m += 8;
+  memcpy(&job.mode, m, 4); m += 4;
+  memcpy(&job.speed, m, 4); m += 4;
+  memcpy(&job.target, m, 8); m += 8;
+  memcpy(&job.steps, m, 4); m += 4;
+  memcpy(&job.dt, m, 8); m += 8;
+  memcpy(&job.seed, m, 4); m += 4;
+  memcpy(&n, m, 4);
+  if (n > EVALUATION_MAX_COEFFICIENTS) {
+    return false;
+  }
+  job.p.resize(n);
+  return socket.receive(job.p.data(), n * 8);
+}
+
+/**
+ * Send the result of a job
+ * @param socket the connection to the coordinator
+ * @param id the id of the job
+ * @param error the error of the run
+ * @return true if successful
+ */
+inline bool sendResult(Socket &socket, uint64_t id, double error) {
+  char message[16];
+  memcpy(message, &id, 8);
+  memcpy(message + 8, &error, 8);
+  return socket.send(message, sizeof(message));
+}
+
+/**
+ * Receive the result of a job
+ * @param socket the connection to the worker
+ * @param id receives the id of the job
+ * @param error receives the error of the run
+ * @return true if successful, false if the connection is closed
+ */
+inline bool receiveResult(Socket &socket, uint64_t &id, double &error) {
+  char message[16];
+  if (!socket.receive(message, sizeof(message))) {
+    return false;
+  }
+  memcpy(&id, message, 8);
+  memcpy(&error, message + 8, 8);
+  return true;
+}
+
+#endif
@@ -0,0 +1,115 @@
+#include <math.h>
+#include "GaussianProcess.h"
+
+// the length scales and the noise variances fitted from
+static const double LENGTH_SCALES[] = {0.05, 0.1, 0.2, 0.3, 0.5, 1.0};
+static const double NOISES[] = {1e-6, 1e-4, 1e-2, 1e-1};
+
+GaussianProcess::GaussianProcess(double length_scale, double noise): length_scale(length_scale), noise(noise) {}
+
+double GaussianProcess::kernel(const VectorXd &a, const VectorXd &b) const {
+  double s = sqrt(5.0) * (a - b).norm() / length_scale;
+  return (1 + s + s * s / 3) * exp(-s);
+}
+
+void GaussianProcess::add(const VectorXd &x, double y) {
+  size_t n = points.size();
+  VectorXd k(n);
+  for (size_t i = 0; i < n; i++) {
+    k[i] = kernel(points[i], x);
+  }
+  // the new row of the factor solves the factor of the points against the kernels of the point
+  VectorXd row = factor.topLeftCorner(n, n).triangularView<Eigen::Lower>().solve(k);
+  double diagonal = 1 + noise - row.squaredNorm();
+  factor.conservativeResize(n + 1, n + 1);
+  factor.row(n).head(n) = row.transpose();
+  factor.col(n).head(n).setZero();
+  factor(n, n) = sqrt(fmax(diagonal, noise));
+  points.push_back(x);
+  values.push_back(y);
+  solve();
+}
+
+void GaussianProcess::truncate(size_t size) {
+  if (size >= points.size()) {
+    return;
+  }
+  points.resize(size);
+  values.resize(size);
+  // the factor of the first points is the top left block of the factor
+  factor.conservativeResize(size, size);
+  solve();
+}
+
+void GaussianProcess::solve() {
+  size_t n = values.size();
+  value_mean = 0;
+  for (size_t i = 0; i < n; i++) {
+    value_mean += values[i];
+  }
+  value_mean = n > 0? value_mean / n: 0;
+  double variance = 0;
+  for (size_t i = 0; i < n; i++) {
+    variance += (values[i] - value_mean) * (values[i] - value_mean);
+  }
+  value_deviation = n > 1 && variance > 0? sqrt(variance / (n - 1)): 1;
+  VectorXd standardized(n);
+  for (size_t i = 0; i < n; i++) {
+    standardized[i] = (values[i] - value_mean) / value_deviation;
+  }
+  weights = factor.triangularView<Eigen::Lower>().solve(standardized);
+  factor.triangularView<Eigen::Lower>().transpose().solveInPlace(weights);
+}
+
+double GaussianProcess::factorize() {
+  size_t n = points.size();
+  MatrixXd matrix(n, n);
+  for (size_t i = 0; i < n; i++) {
+    for (size_t j = 0; j <= i; j++) {
+      matrix(i, j) = matrix(j, i) = kernel(points[i], points[j]) + (i == j? noise: 0);
+    }
+  }
+  Eigen::LLT<MatrixXd> llt(matrix);
+  factor = llt.matrixL();
+  if (llt.info() != Eigen::Success) {
+    return -INFINITY;
+  }
+  solve();
+  // the log marginal likelihood, without the constant term
+  double likelihood = 0;
+  for (size_t i = 0; i < n; i++) {
+    likelihood -= 0.5 * (values[i] - value_mean) / value_deviation * weights[i] + log(factor(i, i));
+  }
+  return likelihood;
+}
+
+double GaussianProcess::fit() {
+  double best_scale = length_scale, best_noise = noise, best_likelihood = -INFINITY;
+  for (size_t i = 0; i < sizeof(LENGTH_SCALES) / sizeof(LENGTH_SCALES[0]); i++) {
+    for (size_t j = 0; j < sizeof(NOISES) / sizeof(NOISES[0]); j++) {
+      length_scale = LENGTH_SCALES[i];
+      noise = NOISES[j];
+      double likelihood = factorize();
+      if (likelihood > best_likelihood) {
+        best_likelihood = likelihood;
+        best_scale = length_scale;
+        best_noise = noise;
+      }
+    }
+  }
+  length_scale = best_scale;
+  noise = best_noise;
+  factorize();
+  return length_scale;
+}
+
+void GaussianProcess::predict(const VectorXd &x, double &mean, double &deviation) const {
+  size_t n = points.size();
+  VectorXd k(n);
+  for (size_t i = 0; i < n; i++) {
+    k[i] = kernel(points[i], x);
+  }
+  VectorXd v = factor.triangularView<Eigen::Lower>().solve(k);
+  mean = value_mean + value_deviation * k.dot(weights);
+  deviation = value_deviation * sqrt(fmax(1 - v.squaredNorm(), 0.0));
+}
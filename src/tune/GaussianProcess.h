@@ -0,0 +1,94 @@
+#ifndef _TUNE_GAUSSIANPROCESS_H_
+#define _TUNE_GAUSSIANPROCESS_H_
+
+#include <vector>
+#include "Eigen/Dense"
+
+using namespace std;
+using Eigen::MatrixXd;
+using Eigen::VectorXd;
+
+/**
+ * GaussianProcess is the regression of a function from its values at points, with a Matern 5/2
+ * kernel of a length scale, unit signal variance and a small noise variance, for values
+ * standardized to zero mean and unit variance. The Cholesky factor of the kernel matrix is
+ * extended by a row when a point is added, in O(n^2) rather than O(n^3), and the last points can
+ * be removed by truncating it, so points with predicted values can be added tentatively. The
+ * length scale is fitted by the marginal likelihood over a grid, which refactors the matrix.
+ */
+class GaussianProcess {
+  // the length scale of the kernel
+  double length_scale;
+  // the noise variance added to the diagonal of the kernel matrix
+  double noise;
+  // the points
+  vector<VectorXd> points;
+  // the values at the points
+  vector<double> values;
+  // the lower Cholesky factor of the kernel matrix of the points
+  MatrixXd factor;
+  // the kernel matrix inverse times the standardized values
+  VectorXd weights;
+  // the mean and the standard deviation of the values
+  double value_mean = 0;
+  double value_deviation = 1;
+
+  /**
+   * Return the kernel of two points
+   */
+  double kernel(const VectorXd &a, const VectorXd &b) const;
+
+  /**
+   * Factor the kernel matrix of all the points
+   * @return the log marginal likelihood of the standardized values, -infinity if the matrix is
+   * not positive definite
+   */
+  double factorize();
+
+  /**
+   * Standardize the values, and solve for the weights
+   */
+  void solve();
+
+public:
+  /**
+   * Constructor
+   * @param length_scale the length scale of the kernel
+   * @param noise the noise variance of the standardized values
+   */
+  GaussianProcess(double length_scale = 0.2, double noise = 1e-6);
+
+  /**
+   * Add a point
+   * @param x the point
+   * @param y the value at the point
+   */
+  void add(const VectorXd &x, double y);
+
+  /**
+   * Remove the points added last
+   * @param size the number of points to keep
+   */
+  void truncate(size_t size);
+
+  /**
+   * Fit the length scale to the points, the one of the largest marginal likelihood on a grid
+   * @return the length scale
+   */
+  double fit();
+
+  /**
+   * Return the number of points
+   */
+  size_t size() const { return points.size(); }
+
+  /**
+   * Predict the value at a point
+   * @param x the point
+   * @param mean receives the mean of the value
+   * @param deviation receives the standard deviation of the value
+   */
+  void predict(const VectorXd &x, double &mean, double &deviation) const;
+};
+
+#endif
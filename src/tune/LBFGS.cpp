@@ -0,0 +1,92 @@
+#include <math.h>
+#include "LBFGS.h"
+
+// the fraction of the decrease predicted by the slope that a step must achieve
+#define SUFFICIENT_DECREASE 1e-4
+// the most halvings of a step
+#define MAX_BACKTRACKS 50
+
+LBFGS::LBFGS(size_t memory, double tolerance, int max_iterations):
+    memory(memory), tolerance(tolerance), max_iterations(max_iterations) {}
+
+double LBFGS::minimize(const Function &f, VectorXd &p, vector<Twiddle::Pass> *passes) {
+  VectorXd gradient, next_gradient;
+  double value = f(p, gradient);
+  evaluations = 1;
+  if (passes) {
+    passes->push_back(Twiddle::Pass{p, VectorXd::Zero(p.size()), value});
+  }
+  // the changes of the coefficients and of the gradient of the last iterations, and the
+  // reciprocals of their dot products
+  deque<VectorXd> steps, changes;
+  deque<double> rhos;
+  vector<double> alphas;
+  for (int iteration = 0; iteration < max_iterations && gradient.squaredNorm() > 0; iteration++) {
+    // the two loop recursion multiplies the gradient by the estimate of the inverse Hessian
+    VectorXd direction = -gradient;
+    alphas.resize(steps.size());
+    for (int i = (int)steps.size() - 1; i >= 0; i--) {
+      alphas[i] = rhos[i] * steps[i].dot(direction);
+      direction -= alphas[i] * changes[i];
+    }
+    if (!steps.empty()) {
+      direction *= steps.back().dot(changes.back()) / changes.back().squaredNorm();
+    }
+    for (size_t i = 0; i < steps.size(); i++) {
+      double beta = rhos[i] * changes[i].dot(direction);
+      direction += (alphas[i] - beta) * steps[i];
+    }
+    double slope = gradient.dot(direction);
+    if (!(slope < 0)) {
+      // the estimate is off, start over from the steepest descent
+      steps.clear();
+      changes.clear();
+      rhos.clear();
+      direction = -gradient;
+      slope = -gradient.squaredNorm();
+    }
+
+    // without an estimate of the Hessian, the first step is at most one in norm
+    double t = steps.empty()? fmin(1.0, 1 / direction.norm()): 1;
+    VectorXd next;
+    double next_value = value;
+    int backtracks = 0;
+    for (; backtracks < MAX_BACKTRACKS; backtracks++) {
+      next = p + t * direction;
+      next_value = f(next, next_gradient);
+      evaluations++;
+      if (next_value <= value + SUFFICIENT_DECREASE * t * slope) {
+        break;
+      }
+      t /= 2;
+    }
+    if (backtracks == MAX_BACKTRACKS) {
+      break;
+    }
+
+    VectorXd step = next - p, change = next_gradient - gradient;
+    double curvature = step.dot(change);
+    // keep the estimate positive definite
+    if (curvature > 1e-12 * step.norm() * change.norm()) {
+      steps.push_back(step);
+      changes.push_back(change);
+      rhos.push_back(1 / curvature);
+      if (steps.size() > memory) {
+        steps.pop_front();
+        changes.pop_front();
+        rhos.pop_front();
+      }
+    }
+    double decrease = value - next_value;
+    p = next;
+    gradient = next_gradient;
+    value = next_value;
+    if (passes) {
+      passes->push_back(Twiddle::Pass{p, step, value});
+    }
+    if (decrease <= tolerance * fabs(value + decrease)) {
+      break;
+    }
+  }
+  return value;
+}
@@ -0,0 +1,64 @@
+#ifndef _TUNE_LBFGS_H_
+#define _TUNE_LBFGS_H_
+
+#include <deque>
+#include <functional>
+#include <vector>
+#include "Eigen/Dense"
+#include "Twiddle.h"
+
+using namespace std;
+using Eigen::VectorXd;
+
+/**
+ * LBFGS minimizes a function with its gradient by the limited memory BFGS method: the direction
+ * of every iteration is the gradient multiplied by an estimate of the inverse Hessian, built from
+ * the changes of the coefficients and of the gradient over the last iterations, and the step
+ * along it is backtracked until the function decreases enough. It stops when the function
+ * decreases by less than a relative tolerance in an iteration, or when the gradient vanishes.
+ * A run of the car with its gradient costs about as much as two runs without, so it converges in
+ * a fraction of the runs twiddling the coefficients one at a time takes.
+ */
+class LBFGS {
+public:
+  /**
+   * The function to minimize: it returns the value at a coefficient vector, and its gradient
+   */
+  typedef function<double(const VectorXd &p, VectorXd &gradient)> Function;
+
+private:
+  // number of iterations whose changes estimate the inverse Hessian
+  size_t memory;
+  // the least relative decrease of an iteration to go on with
+  double tolerance;
+  // the most iterations
+  int max_iterations;
+  // number of evaluations of the function by the last minimization
+  int evaluations = 0;
+
+public:
+  /**
+   * Constructor
+   * @param memory number of iterations whose changes estimate the inverse Hessian
+   * @param tolerance the least relative decrease of an iteration to go on with
+   * @param max_iterations the most iterations
+   */
+  LBFGS(size_t memory = 6, double tolerance = 1e-9, int max_iterations = 200);
+
+  /**
+   * Minimize a function
+   * @param f the function
+   * @param p the starting coefficient vector, receives the coefficients of the minimum found
+   * @param passes receives the state before the first iteration and after every iteration, with
+   * the steps of the coefficients as the adjustments, default is not to record the iterations
+   * @return the value of the minimum found
+   */
+  double minimize(const Function &f, VectorXd &p, vector<Twiddle::Pass> *passes = NULL);
+
+  /**
+   * Return the number of evaluations of the function by the last minimization
+   */
+  int getEvaluations() const { return evaluations; }
+};
+
+#endif
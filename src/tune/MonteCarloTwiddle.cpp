@@ -0,0 +1,67 @@
+#include <math.h>
+#include <random>
+#include "MonteCarloTwiddle.h"
+
+MonteCarloTwiddle::MonteCarloTwiddle(CarTwiddle &car, ThreadPool &pool, int samples, unsigned seed,
+                                     double drift_sigma): errors(samples), risk(0), pool(pool) {
+  statistics.mean = statistics.variance = statistics.worst = 0;
+  statistics.diverged = 0;
+  default_random_engine drift_generator(seed);
+  normal_distribution<double> drift(0, 1);
+  for (int k = 0; k < samples; k++) {
+    cars.push_back(CarTwiddle(car));
+    cars[k].setSeed(seed + k);
+    cars[k].setCommonNoise(true);
+    cars[k].setSteeringDrift(car.getSteeringDrift() + drift_sigma * drift(drift_generator));
+  }
+}
+
+double MonteCarloTwiddle::run(const VectorXd &p, const double target, const int steps, const double dt,
+                              TrajectorySink *trajectory) {
+  // every sample replays its noise, so every run sees the same noise
+  for (size_t k = 0; k < cars.size(); k++) {
+    pool.submit([this, k, &p, target, steps, dt, trajectory]() {
+      errors[k] = cars[k].run(p, target, steps, dt, k == 0? trajectory: NULL);
+    });
+  }
+  pool.wait();
+
+  double sum = 0, worst = 0;
+  int diverged = 0;
+  for (size_t k = 0; k < errors.size(); k++) {
+    sum += errors[k];
+    if (!isfinite(errors[k])) {
+      diverged++;
+    }
+    // NaN errors of diverged samples are the worst, and stay the worst
+    if (!isnan(worst) && !(errors[k] <= worst)) {
+      worst = errors[k];
+    }
+  }
+  double mean = sum / errors.size();
+  double variance = 0;
+  for (size_t k = 0; k < errors.size(); k++) {
+    variance += (errors[k] - mean) * (errors[k] - mean);
+  }
+  variance = errors.size() > 1? variance / (errors.size() - 1): 0;
+  statistics.mean = mean;
+  statistics.variance = variance;
+  statistics.worst = worst;
+  statistics.diverged = diverged;
+  return mean + risk * sqrt(variance);
+}
+
+void MonteCarloTwiddle::saveState(ostream &out) const {
+  for (size_t k = 0; k < cars.size(); k++) {
+    cars[k].saveState(out);
+  }
+}
+
+bool MonteCarloTwiddle::loadState(istream &in) {
+  for (size_t k = 0; k < cars.size(); k++) {
+    if (!cars[k].loadState(in)) {
+      return false;
+    }
+  }
+  return true;
+}
@@ -0,0 +1,90 @@
+#ifndef _TUNE_MONTECARLOTWIDDLE_H_
+#define _TUNE_MONTECARLOTWIDDLE_H_
+
+#include <vector>
+#include "Eigen/Dense"
+#include "Twiddle.h"
+#include "CarTwiddle.h"
+#include "../utils/ThreadPool.h"
+
+using namespace std;
+using Eigen::VectorXd;
+
+/**
+ * MonteCarloTwiddle scores a coefficient vector by running a car over a number of samples, every
+ * sample with its own noise seed and steering drift, so that the tuned coefficients are robust to
+ * the noise instead of fitted to one realization of it. The samples are run in parallel on a pool
+ * of threads shared by the tunings, every sample on its own copy of the car with its own random
+ * number generator.
+ * Every sample keeps its seed and drift across runs, and replays the noise of its seed in every
+ * run, so that the runs of different coefficient vectors are compared on the same noise. The score is the mean error of the samples plus a
+ * multiple of their standard deviation.
+ */
+class MonteCarloTwiddle: public Twiddle {
+public:
+  /**
+   * Statistics of the errors of the samples of a run
+   */
+  struct Statistics {
+    double mean;      // mean error
+    double variance;  // variance of the errors
+    double worst;     // the largest error, NaN if any sample diverged
+    int diverged;     // number of samples whose error is not finite
+  };
+
+private:
+  // the car of every sample
+  vector<CarTwiddle> cars;
+  // the error of every sample of the last run
+  vector<double> errors;
+  // the weight of the standard deviation in the score
+  double risk;
+  // statistics of the last run
+  Statistics statistics;
+  // the threads to run the samples on
+  ThreadPool &pool;
+
+public:
+  /**
+   * Constructor
+   * @param car the car to copy for every sample, with the noise and the mode to run
+   * @param pool the threads to run the samples on
+   * @param samples number of samples
+   * @param seed the seed of the first sample, the seeds of the samples are consecutive
+   * @param drift_sigma standard deviation of the steering drift added to the drift of the car,
+   * drawn once for every sample
+   */
+  MonteCarloTwiddle(CarTwiddle &car, ThreadPool &pool, int samples, unsigned seed = 1, double drift_sigma = 0);
+
+  /**
+   * Set the weight of the standard deviation in the score
+   * @param risk the weight, 0 to score with the mean error only
+   */
+  void setRisk(double risk) { this->risk = risk; }
+
+  /**
+   * Write the states of the cars of the samples
+   * @param out the stream to write to
+   */
+  void saveState(ostream &out) const;
+
+  /**
+   * Read the states of the cars of the samples
+   * @param in the stream to read from
+   */
+  bool loadState(istream &in);
+
+  /**
+   * Return the statistics of the last run
+   */
+  const Statistics &getStatistics() const { return statistics; }
+
+  /**
+   * Run all the samples, and return the mean error plus the weighted standard deviation. The
+   * trajectories are of the first sample
+   */
+  double run(const VectorXd &p, const double target, const int steps, const double dt,
+             TrajectorySink *trajectory);
+};
+
+#endif
@@ -0,0 +1,30 @@
+#include "ParallelTwiddle.h"
+
+ParallelTwiddle::ParallelTwiddle(const CarTwiddle &car, ThreadPool &pool): car(car), pool(pool) {}
+
+double ParallelTwiddle::run(const VectorXd &p, const double target, const int steps, const double dt,
+                            TrajectorySink *trajectory) {
+  addCars(1);
+  return cars[0].run(p, target, steps, dt, trajectory);
+}
+
+vector<double> ParallelTwiddle::runBatch(const vector<VectorXd> &ps, const double target, const int steps,
+                                         const double dt) {
+  addCars(ps.size());
+  errors.resize(ps.size());
+  for (size_t k = 0; k < ps.size(); k++) {
+    pool.submit([this, k, &ps, target, steps, dt]() {
+      errors[k] = cars[k].run(ps[k], target, steps, dt, NULL);
+    });
+  }
+  pool.wait();
+  return errors;
+}
+
+void ParallelTwiddle::addCars(size_t count) {
+  // the copies keep the noise they replay across batches
+  while (cars.size() < count) {
+    cars.push_back(CarTwiddle(car));
+    cars.back().setCommonNoise(true);
+  }
+}
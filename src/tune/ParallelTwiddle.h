@@ -0,0 +1,61 @@
+#ifndef _TUNE_PARALLELTWIDDLE_H_
+#define _TUNE_PARALLELTWIDDLE_H_
+
+#include <vector>
+#include "Eigen/Dense"
+#include "Twiddle.h"
+#include "CarTwiddle.h"
+#include "../utils/ThreadPool.h"
+
+using namespace std;
+using Eigen::VectorXd;
+
+/**
+ * ParallelTwiddle runs the batches of runs of a car on a pool of threads shared by the tunings,
+ * every run of a batch on its own copy of the car. The copies replay the noise of the seed of the car in every run, so
+ * the errors are those of the car with common random numbers, whatever the number of threads and
+ * the order the runs finish in. The copies are made when first needed, so the car must not change
+ * while this twiddle runs.
+ */
+class ParallelTwiddle: public Twiddle {
+  // the car to copy
+  const CarTwiddle &car;
+  // the copy of the car of every run of a batch
+  vector<CarTwiddle> cars;
+  // the error of every run of the last batch
+  vector<double> errors;
+  // the threads to run the batches on
+  ThreadPool &pool;
+
+  /**
+   * Copy the car until there are as many copies as runs
+   * @param count number of runs
+   */
+  void addCars(size_t count);
+
+public:
+  /**
+   * Constructor
+   * @param car the car to copy for every run, with the noise, the seed and the mode to run
+   * @param pool the threads to run the batches on
+   */
+  ParallelTwiddle(const CarTwiddle &car, ThreadPool &pool);
+
+  /**
+   * Run the car with the coefficient vector
+   */
+  double run(const VectorXd &p, const double target, const int steps, const double dt,
+             TrajectorySink *trajectory);
+
+  /**
+   * Run the car with the coefficient vectors in parallel
+   */
+  vector<double> runBatch(const vector<VectorXd> &ps, const double target, const int steps, const double dt);
+
+  /**
+   * Return the number of threads
+   */
+  size_t getThreads() const { return pool.size(); }
+};
+
+#endif
@@ -0,0 +1,33 @@
+#include "RemoteTwiddle.h"
+
+RemoteTwiddle::RemoteTwiddle(Coordinator &coordinator, CarTwiddle &car, int speed):
+    coordinator(coordinator), car(car), speed(speed) {}
+
+double RemoteTwiddle::run(const VectorXd &p, const double target, const int steps, const double dt,
+                          TrajectorySink *trajectory) {
+  if (trajectory) {
+    return car.run(p, target, steps, dt, trajectory);
+  }
+  return coordinator.evaluate(makeJob(p, target, steps, dt));
+}
+
+vector<double> RemoteTwiddle::runBatch(const vector<VectorXd> &ps, const double target, const int steps,
+                                       const double dt) {
+  vector<EvaluationJob> jobs;
+  for (size_t i = 0; i < ps.size(); i++) {
+    jobs.push_back(makeJob(ps[i], target, steps, dt));
+  }
+  return coordinator.evaluate(jobs);
+}
+
+EvaluationJob RemoteTwiddle::makeJob(const VectorXd &p, const double target, const int steps, const double dt) const {
+  EvaluationJob job;
+  job.mode = car.getMode();
+  job.speed = speed;
+  job.target = target;
+  job.steps = steps;
+  job.dt = dt;
+  job.seed = car.getSeed();
+  job.p = p;
+  return job;
+}
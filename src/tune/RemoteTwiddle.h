@@ -0,0 +1,52 @@
+#ifndef _TUNE_REMOTETWIDDLE_H_
+#define _TUNE_REMOTETWIDDLE_H_
+
+#include "Eigen/Dense"
+#include "Twiddle.h"
+#include "CarTwiddle.h"
+#include "Coordinator.h"
+
+using Eigen::VectorXd;
+
+/**
+ * RemoteTwiddle twiddles the coefficients of a car with its runs evaluated by the workers of a
+ * coordinator, which run the car of the same speed bucket, mode and seed, with the noise of the
+ * seed replayed in every run. The car must replay its noise too, common random numbers, so that
+ * its runs are those of the workers, and twiddles of several speed buckets can share the workers.
+ */
+class RemoteTwiddle: public Twiddle {
+  // the coordinator of the workers
+  Coordinator &coordinator;
+  // the car, for its mode and seed
+  CarTwiddle &car;
+  // the speed bucket of the car in mph
+  int speed;
+
+  /**
+   * Return the job of a run of the car
+   */
+  EvaluationJob makeJob(const VectorXd &p, const double target, const int steps, const double dt) const;
+
+public:
+  /**
+   * Constructor
+   * @param coordinator the coordinator of the workers
+   * @param car the car of the speed bucket
+   * @param speed the speed bucket in mph
+   */
+  RemoteTwiddle(Coordinator &coordinator, CarTwiddle &car, int speed);
+
+  /**
+   * Run the car on a worker, and return the mean squared error. The trajectories are recorded by
+   * running the car locally
+   */
+  double run(const VectorXd &p, const double target, const int steps, const double dt,
+             TrajectorySink *trajectory);
+
+  /**
+   * Run the car on as many workers as are free at once
+   */
+  vector<double> runBatch(const vector<VectorXd> &ps, const double target, const int steps, const double dt);
+};
+
+#endif
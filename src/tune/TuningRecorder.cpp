@@ -0,0 +1,56 @@
+#include <fstream>
+#include <memory>
+#include "TuningRecorder.h"
+#include "../utils/LogWriter.h"
+
+TuningRecorder::TuningRecorder(const string &directory): directory(directory), ok(true), writer(1) {}
+
+void TuningRecorder::writeTrajectory(const string &name, vector<TrajectoryPoint> &&points) {
+  // std::function needs a copyable task, so the points are moved to a shared vector
+  shared_ptr<vector<TrajectoryPoint> > data = make_shared<vector<TrajectoryPoint> >(move(points));
+  string path = directory + "/" + name + ".trajectory";
+  writer.submit([this, data, path]() {
+    LogWriter<TrajectoryPoint> log;
+    if (!log.open(path) || !log.append(data->data(), data->size()) || !log.close()) {
+      ok = false;
+    }
+  });
+}
+
+void TuningRecorder::writeConvergence(const string &name, vector<Twiddle::Pass> &&passes) {
+  shared_ptr<vector<Twiddle::Pass> > data = make_shared<vector<Twiddle::Pass> >(move(passes));
+  string path = directory + "/" + name + ".convergence.csv";
+  writer.submit([this, data, path]() {
+    ofstream out(path.c_str());
+    out.precision(17);
+    out << "pass,best";
+    long size = data->empty()? 0: (*data)[0].p.size();
+    for (long i = 0; i < size; i++) {
+      out << ",p" << i;
+    }
+    for (long i = 0; i < size; i++) {
+      out << ",dp" << i;
+    }
+    out << endl;
+    for (size_t k = 0; k < data->size(); k++) {
+      const Twiddle::Pass &pass = (*data)[k];
+      out << k << "," << pass.best;
+      for (long i = 0; i < size; i++) {
+        out << "," << pass.p[i];
+      }
+      for (long i = 0; i < size; i++) {
+        out << "," << pass.dp[i];
+      }
+      out << "\n";
+    }
+    out.close();
+    if (!out) {
+      ok = false;
+    }
+  });
+}
+
+bool TuningRecorder::wait() {
+  writer.wait();
+  return ok;
+}
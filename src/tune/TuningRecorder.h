@@ -0,0 +1,57 @@
+#ifndef _TUNE_TUNINGRECORDER_H_
+#define _TUNE_TUNINGRECORDER_H_
+
+#include <atomic>
+#include <string>
+#include <vector>
+#include "Twiddle.h"
+#include "../sim/TrajectorySink.h"
+#include "../utils/ThreadPool.h"
+
+using namespace std;
+
+/**
+ * TuningRecorder writes the trajectories and the convergence of tuned coefficients to files in a
+ * directory, on a thread of its own, so the tuner hands over the data and goes on tuning while the
+ * files are written. The files are rendered later by twiddle_plot, or any other tool:
+ * - name.trajectory: a log of TrajectoryPoint records, which can be read by MappedLog
+ * - name.convergence.csv: a line for every twiddle pass, with the pass, the least error, and the
+ *   coefficients and their adjustments
+ */
+class TuningRecorder {
+  // the directory of the files
+  string directory;
+  // false if a file failed to be written
+  atomic<bool> ok;
+  // the thread writing the files, declared last so that it is stopped first
+  ThreadPool writer;
+
+public:
+  /**
+   * Constructor
+   * @param directory the directory to write the files to, which must exist
+   */
+  explicit TuningRecorder(const string &directory);
+
+  /**
+   * Write a trajectory in the background
+   * @param name name of the file, without the extension
+   * @param points the points of the trajectory, which are moved to the writer
+   */
+  void writeTrajectory(const string &name, vector<TrajectoryPoint> &&points);
+
+  /**
+   * Write the passes of a twiddle in the background
+   * @param name name of the file, without the extension
+   * @param passes the passes, which are moved to the writer
+   */
+  void writeConvergence(const string &name, vector<Twiddle::Pass> &&passes);
+
+  /**
+   * Wait until all the files are written
+   * @return true if all the files were written
+   */
+  bool wait();
+};
+
+#endif
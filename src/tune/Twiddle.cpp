@@ -1,14 +1,61 @@
 #include "Twiddle.h"
-#include <iostream>
+#include <algorithm>
+#include <sstream>
 
-double Twiddle::twiddle(VectorXd &p, const double target, const int steps, const double dt, double threshold) {
-  p.setZero();
-  VectorXd dp(p.size());
-  dp.fill(1.);
-  double best = run(p, target, steps, dt);
+void Twiddle::setCheckpoint(TwiddleCheckpoint *checkpoint, const string &key) {
+  this->checkpoint = checkpoint;
+  checkpoint_key = key;
+}
+
+void Twiddle::saveCheckpoint(const TwiddleCheckpoint::State &state) {
+  ostringstream model;
+  saveState(model);
+  TwiddleCheckpoint::State saved = state;
+  saved.model = model.str();
+  if (!checkpoint->update(checkpoint_key, saved)) {
+    // the twiddle goes on, it can only not be resumed from here
+    std::cerr << "Failed to write checkpoint: " << checkpoint_key << std::endl;
+  }
+}
+
+vector<double> Twiddle::runBatch(const vector<VectorXd> &ps, const double target, const int steps, const double dt) {
+  vector<double> errors(ps.size());
+  for (size_t i = 0; i < ps.size(); i++) {
+    errors[i] = run(ps[i], target, steps, dt);
+  }
+  return errors;
+}
+
+double Twiddle::twiddle(VectorXd &p, const double target, const int steps, const double dt, double threshold,
+                        vector<Pass> *passes) {
+  TwiddleCheckpoint::State state;
+  const TwiddleCheckpoint::State *resumed = checkpoint? checkpoint->find(checkpoint_key): NULL;
+  if (resumed) {
+    istringstream model(resumed->model);
+    if (resumed->p.size() != p.size() || !loadState(model)) {
+      throw "Checkpoint of a different twiddle";
+    }
+    state = *resumed;
+    p = state.p;
+    if (state.finished) {
+      return state.best;
+    }
+  } else {
+    p.setZero();
+    state.dp.setOnes(p.size());
+    state.best = run(p, target, steps, dt);
+    state.iteration = 0;
+    state.index = 0;
+  }
+  VectorXd &dp = state.dp;
+  double &best = state.best;
   double error = 0;
-  while (dp.sum() > threshold) {
-    for (int i = 0; i < p.size(); i++) {
+  if (passes) {
+    passes->push_back(Pass{p, dp, best});
+  }
+  // a twiddle resumed within a pass finishes the pass first
+  while (state.index > 0 || dp.sum() > threshold) {
+    for (int i = state.index; i < p.size(); i++) {
       p[i] += dp[i];
       error = run(p, target, steps, dt);
       if (error < best) {
@@ -28,8 +75,99 @@ double Twiddle::twiddle(VectorXd &p, const double target, const int steps, const
 #ifdef VERBOSE_OUT
       std::cout << "Twiddle: " << p[0] << " " << p[1] << " " << p[2] << ", " << dp[0] << " " << dp[1] << " " << dp[2] << ", Error: " << error << " " << best << std::endl;
 #endif
+      state.iteration++;
+      if (checkpoint && checkpoint->isDue(checkpoint_key)) {
+        state.index = i + 1;
+        state.p = p;
+        state.finished = false;
+        saveCheckpoint(state);
+      }
+    }
+    state.index = 0;
+    if (passes) {
+      passes->push_back(Pass{p, dp, best});
     }
   }
 
+  if (checkpoint) {
+    state.p = p;
+    state.finished = true;
+    saveCheckpoint(state);
+  }
+  return best;
+}
+
+double Twiddle::twiddleBatch(VectorXd &p, const double target, const int steps, const double dt, double threshold,
+                             int width, vector<Pass> *passes) {
+  // the coefficients looked ahead, the most whose runs fit in a batch
+  int depth = 0;
+  for (int runs = 2; runs <= width; runs = 3 * runs + 2) {
+    depth++;
+  }
+  if (depth == 0) {
+    return twiddle(p, target, steps, dt, threshold, passes);
+  }
+  p.setZero();
+  VectorXd dp = VectorXd::Ones(p.size());
+  double best = run(p, target, steps, dt);
+  if (passes) {
+    passes->push_back(Pass{p, dp, best});
+  }
+  while (dp.sum() > threshold) {
+    for (int start = 0; start < p.size(); start += depth) {
+      int levels = min(depth, (int)p.size() - start);
+      // the states before every coefficient of the batch, 3^level of them: the state after the
+      // increase of the coefficient, after its decrease, and after neither, for every state before
+      // it, which are the states twiddle may be in
+      vector<vector<VectorXd> > states_p(levels + 1), states_dp(levels + 1);
+      states_p[0].push_back(p);
+      states_dp[0].push_back(dp);
+      vector<VectorXd> candidates;
+      for (int level = 0; level < levels; level++) {
+        int i = start + level;
+        for (size_t k = 0; k < states_p[level].size(); k++) {
+          // the changes of the coefficient are computed as twiddle computes them
+          VectorXd increased = states_p[level][k], decreased, restored;
+          increased[i] += states_dp[level][k][i];
+          decreased = increased;
+          decreased[i] -= 2 * states_dp[level][k][i];
+          restored = decreased;
+          restored[i] += states_dp[level][k][i];
+          candidates.push_back(increased);
+          candidates.push_back(decreased);
+          VectorXd grown = states_dp[level][k], shrunk = states_dp[level][k];
+          grown[i] *= 1.1;
+          shrunk[i] *= 0.9;
+          states_p[level + 1].push_back(increased);
+          states_dp[level + 1].push_back(grown);
+          states_p[level + 1].push_back(decreased);
+          states_dp[level + 1].push_back(grown);
+          states_p[level + 1].push_back(restored);
+          states_dp[level + 1].push_back(shrunk);
+        }
+      }
+      vector<double> errors = runBatch(candidates, target, steps, dt);
+      // follow the runs twiddle would take through the states
+      size_t state = 0, offset = 0;
+      for (int level = 0; level < levels; level++) {
+        double increased = errors[offset + 2 * state], decreased = errors[offset + 2 * state + 1];
+        offset += 2 * states_p[level].size();
+        int outcome = 2;
+        if (increased < best) {
+          best = increased;
+          outcome = 0;
+        } else if (decreased < best) {
+          best = decreased;
+          outcome = 1;
+        }
+        state = 3 * state + outcome;
+      }
+      p = states_p[levels][state];
+      dp = states_dp[levels][state];
+    }
+    if (passes) {
+      passes->push_back(Pass{p, dp, best});
+    }
+  }
   return best;
-}
\ No newline at end of file
+}
@@ -2,35 +2,117 @@
 #define _TUNE_TWIDDLE_H_
 
 //#define VERBOSE_OUT
+#include <iostream>
+#include <string>
 #include <vector>
 #include "Eigen/Dense"
+#include "TwiddleCheckpoint.h"
+#include "../sim/TrajectorySink.h"
 
 using namespace std;
 using Eigen::VectorXd;
 
 class Twiddle {
+  // the checkpoints of the twiddle, NULL for no checkpoints
+  TwiddleCheckpoint *checkpoint = NULL;
+  // the key of the twiddle in the checkpoints
+  string checkpoint_key;
+
+  /**
+   * Save the state of the twiddle to the checkpoints
+   */
+  void saveCheckpoint(const TwiddleCheckpoint::State &state);
+
 public:
+  virtual ~Twiddle() {}
+
+  /**
+   * The state of the twiddle after a pass over the coefficients
+   */
+  struct Pass {
+    VectorXd p;   // the coefficients
+    VectorXd dp;  // the adjustments of the coefficients
+    double best;  // the least error so far
+  };
+
   /**
    * Run the simulation model, and return the squared mean error
    * @param p the coefficient vector
    * @param target the target value to reach
    * @param steps the steps required to reach a convergence 
    * @param dt the delta time for each step
-   * @param x_trajectory store the x trajectory, default is not to store the trajectory
-   * @param y_trajectory store the y trajectory, default is not to store the trajectory
+   * @param trajectory receives the trajectory, default is not to record the trajectory
    */ 
   virtual double run(const VectorXd &p, const double target = 0, const int steps = 100,
-      const double dt = 0.05, vector<double> *x_trajectory=NULL, vector<double> *y_trajectory=NULL) = 0;
+      const double dt = 0.05, TrajectorySink *trajectory = NULL) = 0;
+
+  /**
+   * Run the simulation model with several coefficient vectors, and return their squared mean
+   * errors. The runs are one after another, models that can run them in parallel override it
+   * @param ps the coefficient vectors
+   * @param target the target value to reach
+   * @param steps the steps required to reach a convergence
+   * @param dt the delta time for each step
+   */
+  virtual vector<double> runBatch(const vector<VectorXd> &ps, const double target, const int steps, const double dt);
+
+  /**
+   * Write the state of the model that changes from run to run, e.g. its random number generator,
+   * so that the runs of a resumed twiddle are the same as those of an uninterrupted one
+   * @param out the stream to write to
+   */
+  virtual void saveState(ostream &out) const {}
 
   /**
-   * Twiddle the coefficient vector
+   * Read the state written by saveState
+   * @param in the stream to read from
+   * @return true if successful
+   */
+  virtual bool loadState(istream &in) { return true; }
+
+  /**
+   * Checkpoint the twiddle, and resume it from its last checkpoint if there is one
+   * @param checkpoint the checkpoints, NULL for no checkpoints. It must outlive the twiddle
+   * @param key the key of the twiddle in the checkpoints
+   */
+  void setCheckpoint(TwiddleCheckpoint *checkpoint, const string &key);
+
+  /**
+   * Twiddle the coefficient vector. With checkpoints, the state is saved between coefficient
+   * adjustments once the interval of the checkpoints has passed, and when the twiddle is done. A
+   * twiddle with a checkpoint resumes from it, and a done twiddle returns the coefficients and the
+   * error it was done with
    * @param p the coefficient vector
    * @param the target value to reach
    * @param steps the steps assumed for convergence
    * @param dt the delta time for each step
    * @param threshold the adjustment threshold
+   * @param passes receives the state before the first pass and after every pass, to follow the
+   * convergence, default is not to record the passes. A resumed twiddle records the passes from
+   * the checkpoint
+   * @throw if the checkpoint of the twiddle is of a different number of coefficients or model
    */ 
-  double twiddle(VectorXd &p, const double target, const int steps, const double dt, double threshold);
+  double twiddle(VectorXd &p, const double target, const int steps, const double dt, double threshold,
+                 vector<Pass> *passes = NULL);
+
+  /**
+   * Twiddle the coefficient vector in batches of runs, which the model can run in parallel. The
+   * batch of the next coefficients holds the runs of every state twiddle may be in before each of
+   * them: two runs for the first, six for the second, eighteen for the third, so a pass over the
+   * coefficients takes a fraction of the rounds of runs, and far more runs. Twiddle's comparisons
+   * are then made on the errors of the batch, so the coefficients and the error are those of
+   * twiddle, if the runs of the same coefficients have the same error. It is not checkpointed
+   * @param p the coefficient vector
+   * @param the target value to reach
+   * @param steps the steps assumed for convergence
+   * @param dt the delta time for each step
+   * @param threshold the adjustment threshold
+   * @param width the most runs of a batch, below 2 to twiddle
+   * @param passes receives the state before the first pass and after every pass, to follow the
+   * convergence, default is not to record the passes
+   */
+  double twiddleBatch(VectorXd &p, const double target, const int steps, const double dt, double threshold,
+                      int width, vector<Pass> *passes = NULL);
 };
 
 #endif
\ No newline at end of file
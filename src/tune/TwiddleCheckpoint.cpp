@@ -0,0 +1,150 @@
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <fstream>
+#include "TwiddleCheckpoint.h"
+
+static const char MAGIC[4] = {'T', 'W', 'C', 'K'};
+static const uint32_t VERSION = 2;
+
+/**
+ * Write a string with its length
+ */
+static void writeString(ofstream &out, const string &s) {
+  uint32_t length = s.size();
+  out.write((const char *)&length, sizeof(length));
+  out.write(s.data(), length);
+}
+
+/**
+ * Read a string written by writeString
+ */
+static bool readString(ifstream &in, string &s) {
+  uint32_t length;
+  if (!in.read((char *)&length, sizeof(length))) {
+    return false;
+  }
+  s.resize(length);
+  return length == 0 || bool(in.read(&s[0], length));
+}
+
+TwiddleCheckpoint::TwiddleCheckpoint(const string &path, double interval):
+    path(path), interval(interval), options(0) {}
+
+uint64_t TwiddleCheckpoint::hash(const string &text) {
+  // 64 bit FNV-1a
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < text.size(); i++) {
+    h = (h ^ (unsigned char)text[i]) * 1099511628211ULL;
+  }
+  return h;
+}
+
+void TwiddleCheckpoint::setOptions(uint64_t options) {
+  lock_guard<mutex> guard(lock);
+  this->options = options;
+}
+
+uint64_t TwiddleCheckpoint::getOptions() const {
+  lock_guard<mutex> guard(lock);
+  return options;
+}
+
+bool TwiddleCheckpoint::load() {
+  ifstream in(path.c_str(), ios::binary);
+  char magic[4];
+  uint32_t version, count;
+  uint64_t loaded_options;
+  if (!in.read(magic, sizeof(magic)) || memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 ||
+      !in.read((char *)&version, sizeof(version)) || version != VERSION ||
+      !in.read((char *)&loaded_options, sizeof(loaded_options)) || !in.read((char *)&count, sizeof(count))) {
+    return false;
+  }
+  map<string, State> loaded;
+  for (uint32_t k = 0; k < count; k++) {
+    string key;
+    State state;
+    uint8_t finished;
+    int64_t iteration;
+    int32_t index;
+    uint32_t n;
+    if (!readString(in, key) || !in.read((char *)&finished, sizeof(finished)) ||
+        !in.read((char *)&iteration, sizeof(iteration)) || !in.read((char *)&index, sizeof(index)) ||
+        !in.read((char *)&n, sizeof(n)) || index < 0 || index > (int32_t)n) {
+      return false;
+    }
+    state.finished = finished != 0;
+    state.iteration = iteration;
+    state.index = index;
+    state.p.resize(n);
+    state.dp.resize(n);
+    if (!in.read((char *)state.p.data(), n * sizeof(double)) || !in.read((char *)state.dp.data(), n * sizeof(double)) ||
+        !in.read((char *)&state.best, sizeof(state.best)) || !readString(in, state.model)) {
+      return false;
+    }
+    loaded[key] = state;
+  }
+  lock_guard<mutex> guard(lock);
+  states.swap(loaded);
+  options = loaded_options;
+  return true;
+}
+
+bool TwiddleCheckpoint::save() {
+  lock_guard<mutex> guard(lock);
+  return write();
+}
+
+bool TwiddleCheckpoint::write() {
+  string temporary = path + ".tmp";
+  ofstream out(temporary.c_str(), ios::binary);
+  if (!out) {
+    return false;
+  }
+  uint32_t count = states.size();
+  out.write(MAGIC, sizeof(MAGIC));
+  out.write((const char *)&VERSION, sizeof(VERSION));
+  out.write((const char *)&options, sizeof(options));
+  out.write((const char *)&count, sizeof(count));
+  for (map<string, State>::const_iterator it = states.begin(); it != states.end(); ++it) {
+    const State &state = it->second;
+    uint8_t finished = state.finished;
+    int64_t iteration = state.iteration;
+    int32_t index = state.index;
+    uint32_t n = state.p.size();
+    writeString(out, it->first);
+    out.write((const char *)&finished, sizeof(finished));
+    out.write((const char *)&iteration, sizeof(iteration));
+    out.write((const char *)&index, sizeof(index));
+    out.write((const char *)&n, sizeof(n));
+    out.write((const char *)state.p.data(), n * sizeof(double));
+    out.write((const char *)state.dp.data(), n * sizeof(double));
+    out.write((const char *)&state.best, sizeof(state.best));
+    writeString(out, state.model);
+  }
+  out.close();
+  return bool(out) && rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+const TwiddleCheckpoint::State *TwiddleCheckpoint::find(const string &key) const {
+  lock_guard<mutex> guard(lock);
+  map<string, State>::const_iterator it = states.find(key);
+  return it == states.end()? NULL: &it->second;
+}
+
+bool TwiddleCheckpoint::isDue(const string &key) {
+  lock_guard<mutex> guard(lock);
+  chrono::steady_clock::time_point now = chrono::steady_clock::now();
+  map<string, chrono::steady_clock::time_point>::iterator it = saved.find(key);
+  if (it == saved.end()) {
+    it = saved.insert(make_pair(key, now)).first;
+  }
+  return chrono::duration<double>(now - it->second).count() >= interval;
+}
+
+bool TwiddleCheckpoint::update(const string &key, const State &state) {
+  lock_guard<mutex> guard(lock);
+  states[key] = state;
+  saved[key] = chrono::steady_clock::now();
+  return write();
+}
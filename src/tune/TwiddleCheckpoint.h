@@ -0,0 +1,122 @@
+#ifndef _TUNE_TWIDDLECHECKPOINT_H_
+#define _TUNE_TWIDDLECHECKPOINT_H_
+
+#include <stdint.h>
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include "Eigen/Dense"
+
+using namespace std;
+using Eigen::VectorXd;
+
+/**
+ * TwiddleCheckpoint keeps the states of the twiddles of a sweep in a file, so that a sweep that
+ * is killed resumes where its last checkpoint left off, and ends with the same coefficients as if
+ * it had not been killed. Every twiddle of the sweep has a key, e.g. its mode and speed bucket,
+ * and its state between coefficient adjustments: the coefficients, the adjustments, the least
+ * error, the next coefficient to adjust, and the state of the model, e.g. its random number
+ * generator. A finished twiddle keeps its final state, so a resumed sweep skips it.
+ * The states are only valid for the options the sweep runs with, e.g. the noise and the number of
+ * steps, so the checkpoint keeps a hash of them, and a sweep is resumed only with the same hash.
+ * The file is binary: a header with the magic "TWCK", the version, the hash of the options and the
+ * number of states, followed by the states. It is written to a temporary file which is renamed over the file, so a
+ * sweep killed while writing keeps the previous checkpoint. The twiddles of a sweep can run on
+ * several threads at once.
+ */
+class TwiddleCheckpoint {
+public:
+  /**
+   * The state of a twiddle
+   */
+  struct State {
+    bool finished;        // true if the twiddle is done
+    long long iteration;  // number of coefficient adjustments done
+    int index;            // the coefficient to adjust next, in the current pass
+    VectorXd p;           // the coefficients
+    VectorXd dp;          // the adjustments of the coefficients
+    double best;          // the least error so far
+    string model;         // the state of the model
+  };
+
+private:
+  // the file path
+  string path;
+  // seconds between checkpoints
+  double interval;
+  // the hash of the options of the sweep
+  uint64_t options;
+  // the states of the twiddles by key
+  map<string, State> states;
+  // the time of the last save of every twiddle by key, or when it was first checked if it is not saved
+  map<string, chrono::steady_clock::time_point> saved;
+  // guards the states and the times of the saves
+  mutable mutex lock;
+
+  /**
+   * Save the states to the file, with the lock held
+   */
+  bool write();
+
+public:
+  /**
+   * Constructor
+   * @param path the file path
+   * @param interval seconds between checkpoints of a twiddle, 0 for a checkpoint after every
+   * coefficient adjustment
+   */
+  TwiddleCheckpoint(const string &path, double interval = 60);
+
+  /**
+   * Return the hash of a text, which is the same on every platform and build
+   * @param text the text, e.g. the options of a sweep
+   */
+  static uint64_t hash(const string &text);
+
+  /**
+   * Set the hash of the options of the sweep, which is saved with the states
+   * @param options the hash
+   */
+  void setOptions(uint64_t options);
+
+  /**
+   * Return the hash of the options of the sweep, that of the file once it is loaded
+   */
+  uint64_t getOptions() const;
+
+  /**
+   * Load the states and the hash of the options from the file
+   * @return true if successful, false if the file is missing or it is not a checkpoint
+   */
+  bool load();
+
+  /**
+   * Save the states to the file
+   * @return true if successful
+   */
+  bool save();
+
+  /**
+   * Return the state of a twiddle, NULL if there is none
+   * @param key the key of the twiddle
+   */
+  const State *find(const string &key) const;
+
+  /**
+   * Return true if the interval has passed since the last save of a twiddle, or since it was first
+   * checked, so that the twiddles of a sweep running at once checkpoint on their own intervals
+   * @param key the key of the twiddle
+   */
+  bool isDue(const string &key);
+
+  /**
+   * Set the state of a twiddle, and save the states
+   * @param key the key of the twiddle
+   * @param state the state
+   * @return true if successful
+   */
+  bool update(const string &key, const State &state);
+};
+
+#endif
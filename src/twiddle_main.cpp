@@ -1,15 +1,75 @@
 #include <math.h>
+#include <chrono>
+#include <fstream>
 #include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <vector>
 #include "Eigen/Dense"
 #include "tune/CarTwiddle.h"
-#ifdef PLOT_WITH_MATPLOT
-#include "matplotlibcpp.h"
-namespace plt = matplotlibcpp;
-#endif
+#include "tune/MonteCarloTwiddle.h"
+#include "control/GainSchedule.h"
+#include "sim/Track.h"
+#include "sim/MemoryTrajectorySink.h"
+#include "tune/TuningRecorder.h"
+#include "tune/TwiddleCheckpoint.h"
+#include "tune/Coordinator.h"
+#include "tune/RemoteTwiddle.h"
+#include "tune/LBFGS.h"
+#include "tune/BayesTuner.h"
+#include "tune/ParallelTwiddle.h"
+#include "utils/Socket.h"
+#include "utils/ThreadPool.h"
 
 using Eigen::VectorXd;
 
+/**
+ * Evaluate the jobs of a coordinator until it disconnects
+ * @param address the address of the coordinator
+ * @param options the hash of the options the cars are built with, which must be those of the coordinator
+ * @param makeCar returns the car of a speed bucket
+ */
+template<typename MakeCar> void runWorker(const std::string &address, uint64_t options, MakeCar makeCar) {
+  Socket socket;
+  // the coordinator may not be listening yet
+  for (int attempt = 0; !socket.connect(address); attempt++) {
+    if (attempt == 300) {
+      std::cerr << "Failed to connect: " << address << std::endl;
+      exit(-1);
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  uint64_t coordinator_options;
+  if (!sendOptions(socket, options) || !receiveOptions(socket, coordinator_options)) {
+    std::cerr << "The coordinator closed the connection: " << address << std::endl;
+    exit(-1);
+  }
+  if (coordinator_options != options) {
+    std::cerr << "The coordinator builds its cars with other options: " << address << std::endl;
+    exit(-1);
+  }
+  // the cars of the speed buckets and modes evaluated so far
+  std::map<std::pair<int, int>, std::unique_ptr<CarTwiddle> > cars;
+  uint64_t id;
+  EvaluationJob job;
+  while (receiveJob(socket, id, job)) {
+    std::unique_ptr<CarTwiddle> &car = cars[std::make_pair(job.speed, job.mode)];
+    if (!car) {
+      car = makeCar(job.speed);
+      car->setMode(job.mode);
+    }
+    if (car->getSeed() != job.seed) {
+      car->setSeed(job.seed);
+    }
+    if (!sendResult(socket, id, car->run(job.p, job.target, job.steps, job.dt, NULL))) {
+      break;
+    }
+  }
+}
+
 int main(int argc, char* argv[]) {
   double noise[2] = {0.0, 0.0}; // no noise
   double dt = 0.1; // delta time
@@ -20,6 +80,33 @@ int main(int argc, char* argv[]) {
   double y = 1; // y coordinate
   double length = 2.5; // vehicle length
   bool accel = false; // true for acceleration mode, false for steering mode
+  bool joint = false; // true to tune the steering and the acceleration together
+  double jitter = 0; // relative jitter of delta time
+  bool timed = false; // true to control with the time aware PID
+  double tau = 0; // time constant of the derivative filter of the time aware PID
+  double windup = 0; // anti-windup integral limit of the time aware PID
+  std::string schedule_file = ""; // the gain schedule file to write
+  Track track; // the track to follow in the steering mode
+  bool follow_track = false; // true to follow the track instead of the x axis
+  unsigned seed = std::default_random_engine::default_seed; // seed of the noise
+  bool common_noise = false; // true to replay the same noise in every run
+  bool fast_noise = false; // true to draw the noise from the batched normal generator
+  bool fast_math = false; // true to move the car with the fast approximations
+  int integrator = Vehicle::ARC_INTEGRATOR; // the integrator of the car model
+  int samples = 0; // number of Monte Carlo samples, 0 to tune with a single run
+  double drift_sigma = 0; // standard deviation of the steering drift of the samples
+  double risk = 0; // weight of the standard deviation of the sample errors in the score
+  int threads = 0; // number of threads of the samples, 0 for the number of hardware threads
+  std::string plot_dir = ""; // the directory to write the trajectories and the convergence to
+  std::string checkpoint_file = ""; // the file to checkpoint the sweep to, and resume it from
+  double checkpoint_interval = 60; // seconds between checkpoints
+  std::string listen_address = ""; // the address to coordinate workers on
+  std::string worker_address = ""; // the address of the coordinator to work for
+  double lbfgs_threshold = 0; // the threshold of a coarse twiddle refined with L-BFGS, 0 not to refine
+  int bayes_evaluations = 0; // number of runs of Bayesian optimization, 0 to twiddle
+  int batch = 4; // number of runs of a batch of Bayesian optimization
+  double steering_bounds[3] = {2, 5, 0.05}; // the bounds of the steering coefficients of Bayesian optimization
+  double accel_bounds[3] = {30, 5, 0.01}; // the bounds of the acceleration coefficients of Bayesian optimization
 
   // Process command line options
   for (int i = 1; i < argc; i++) {
@@ -60,39 +147,390 @@ int main(int argc, char* argv[]) {
       }
     } else if (std::string((argv[i])) == "-accel") { // tune speed acceleration
       accel = true;
+    } else if (std::string((argv[i])) == "-joint") { // tune steering and acceleration together
+      joint = true;
+    } else if (std::string((argv[i])) == "-jitter") { // delta time jitter
+      if (sscanf(argv[++i], "%lf", &jitter) != 1 || jitter < 0 || jitter >= 1) {
+        std::cerr << "Invalid jitter: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-schedule") { // gain schedule file to write
+      schedule_file = argv[++i];
+    } else if (std::string((argv[i])) == "-track") { // track to follow
+      if (!track.load(argv[++i])) {
+        std::cerr << "Invalid track: " << argv[i] << std::endl;
+        exit(-1);
+      }
+      follow_track = true;
+    } else if (std::string((argv[i])) == "-noise") { // acceleration and steering noise
+      if (sscanf(argv[++i], "%lf", &noise[0]) != 1 || noise[0] < 0) {
+        std::cerr << "Invalid acceleration noise: " << argv[i] << std::endl;
+        exit(-1);
+      }
+      if (sscanf(argv[++i], "%lf", &noise[1]) != 1 || noise[1] < 0) {
+        std::cerr << "Invalid steering noise: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-seed") { // seed of the noise
+      if (sscanf(argv[++i], "%u", &seed) != 1) {
+        std::cerr << "Invalid seed: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-crn") { // common random numbers
+      common_noise = true;
+    } else if (std::string((argv[i])) == "-fast_noise") { // batched normal generator
+      fast_noise = true;
+    } else if (std::string((argv[i])) == "-fast_math") { // fast kinematic model
+      fast_math = true;
+    } else if (std::string((argv[i])) == "-integrator") { // integrator of the car model
+      std::string name = argv[++i];
+      if (name == "arc") {
+        integrator = Vehicle::ARC_INTEGRATOR;
+      } else if (name == "rk4") {
+        integrator = Vehicle::RK4_INTEGRATOR;
+      } else if (name == "adaptive") {
+        integrator = Vehicle::ADAPTIVE_INTEGRATOR;
+      } else {
+        std::cerr << "Invalid integrator: " << name << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-mc") { // Monte Carlo samples
+      if (sscanf(argv[++i], "%d", &samples) != 1 || samples <= 0) {
+        std::cerr << "Invalid samples: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-mc_drift") { // drift of the samples
+      if (sscanf(argv[++i], "%lf", &drift_sigma) != 1 || drift_sigma < 0) {
+        std::cerr << "Invalid drift deviation: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-risk") { // weight of the standard deviation
+      if (sscanf(argv[++i], "%lf", &risk) != 1 || risk < 0) {
+        std::cerr << "Invalid risk: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-threads") { // number of threads
+      if (sscanf(argv[++i], "%d", &threads) != 1 || threads < 0) {
+        std::cerr << "Invalid threads: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-plot") { // plot data directory
+      plot_dir = argv[++i];
+    } else if (std::string((argv[i])) == "-checkpoint") { // checkpoint file
+      checkpoint_file = argv[++i];
+    } else if (std::string((argv[i])) == "-checkpoint_interval") { // seconds between checkpoints
+      if (sscanf(argv[++i], "%lf", &checkpoint_interval) != 1 || checkpoint_interval < 0) {
+        std::cerr << "Invalid checkpoint interval: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-lbfgs") { // refine a coarse twiddle with L-BFGS
+      if (sscanf(argv[++i], "%lf", &lbfgs_threshold) != 1 || lbfgs_threshold <= 0) {
+        std::cerr << "Invalid L-BFGS threshold: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-bayes") { // tune with Bayesian optimization
+      if (sscanf(argv[++i], "%d", &bayes_evaluations) != 1 || bayes_evaluations <= 0) {
+        std::cerr << "Invalid evaluations: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-batch") { // runs of a batch of Bayesian optimization
+      if (sscanf(argv[++i], "%d", &batch) != 1 || batch <= 0) {
+        std::cerr << "Invalid batch: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-bounds") { // bounds of the coefficients of Bayesian optimization
+      for (int k = 0; k < 3; k++) {
+        if (sscanf(argv[++i], "%lf", &steering_bounds[k]) != 1 || steering_bounds[k] <= 0) {
+          std::cerr << "Invalid bound: " << argv[i] << std::endl;
+          exit(-1);
+        }
+        accel_bounds[k] = steering_bounds[k];
+      }
+    } else if (std::string((argv[i])) == "-listen") { // coordinate workers
+      listen_address = argv[++i];
+    } else if (std::string((argv[i])) == "-worker") { // work for a coordinator
+      worker_address = argv[++i];
+    } else if (std::string((argv[i])) == "-timed") { // use time aware PID
+      timed = true;
+    } else if (std::string((argv[i])) == "-tau") { // derivative filter time constant
+      if (sscanf(argv[++i], "%lf", &tau) != 1 || tau < 0) {
+        std::cerr << "Invalid tau: " << argv[i] << std::endl;
+        exit(-1);
+      }
+    } else if (std::string((argv[i])) == "-windup") { // integral limit
+      if (sscanf(argv[++i], "%lf", &windup) != 1 || windup < 0) {
+        std::cerr << "Invalid windup: " << argv[i] << std::endl;
+        exit(-1);
+      }
     } else {
       std::cerr << "Unknown option: " << argv[i] << std::endl;
       exit(-1);
     }
   }
 
-  for (int v = 50; v <= velocity; v += 10) {
-    CarTwiddle car(length, 0, y, 0, v * 1.61 * 1000 / 3600.0, noise, drift);
+  if (samples > 0 && !listen_address.empty()) {
+    std::cerr << "Monte Carlo samples are not evaluated by workers" << std::endl;
+    exit(-1);
+  }
+  if (lbfgs_threshold > 0 && (samples > 0 || !listen_address.empty())) {
+    std::cerr << "L-BFGS refines the runs of a single car" << std::endl;
+    exit(-1);
+  }
+  if (lbfgs_threshold > 0 && (fast_math || integrator != Vehicle::ARC_INTEGRATOR)) {
+    std::cerr << "L-BFGS differentiates the runs along the exact arc, not with -fast_math or -integrator" << std::endl;
+    exit(-1);
+  }
+  if (!schedule_file.empty() && velocity < 50) {
+    std::cerr << "The gain schedule starts at 50 mph, use a speed of at least 50" << std::endl;
+    exit(-1);
+  }
+  if ((tau > 0 || windup > 0) && !timed) {
+    std::cerr << "The derivative filter and the integral limit are those of the time aware PID, use -timed" << std::endl;
+    exit(-1);
+  }
+  if (joint && !checkpoint_file.empty()) {
+    std::cerr << "Joint tuning is not checkpointed" << std::endl;
+    exit(-1);
+  }
+  if (fast_noise && !checkpoint_file.empty()) {
+    std::cerr << "The batched noise is not checkpointed" << std::endl;
+    exit(-1);
+  }
+  if (bayes_evaluations > 0 && !checkpoint_file.empty()) {
+    std::cerr << "Bayesian optimization is not checkpointed" << std::endl;
+    exit(-1);
+  }
+
+  // the runs of the joint twiddle at once on the threads, the workers set it when coordinating them
+  int width = threads > 0? threads: std::thread::hardware_concurrency();
+
+  // The gain schedule has a grid point for every speed bucket
+  GainSchedule schedule(50, 10, velocity >= 50? (int(velocity) - 50) / 10 + 1: 0);
+  bool tune_schedule = !schedule_file.empty();
+  // the options the cars are built with, the workers must build theirs with the same options, as
+  // the jobs carry only the mode, the speed bucket, the target, the steps, the delta time and the seed
+  std::ostringstream car_options;
+  car_options.precision(17);
+  car_options << "y " << y << " len " << length << " drift " << drift << " jitter " << jitter << " timed " << timed
+              << " tau " << tau << " windup " << windup << " noise " << noise[0] << " " << noise[1]
+              << " fast_math " << fast_math << " integrator " << integrator << " fast_noise " << fast_noise;
+  if (follow_track) {
+    car_options << " track";
+    for (int i = 0; i < track.size(); i++) {
+      car_options << " " << track.getX(i) << " " << track.getY(i);
+    }
+  }
+  // the checkpoints of the sweep, resumed from the file if it exists
+  std::unique_ptr<TwiddleCheckpoint> checkpoint;
+  if (!checkpoint_file.empty()) {
+    // the options the runs depend on, the speed buckets and the modes are the keys of the states
+    std::ostringstream options;
+    options.precision(17);
+    options << "steps " << steps << " dt " << dt << " target " << target << " seed " << seed
+            << " crn " << common_noise << " mc " << samples << " " << drift_sigma << " " << risk
+            << " lbfgs " << lbfgs_threshold << " remote " << !listen_address.empty() << " " << car_options.str();
+    uint64_t options_hash = TwiddleCheckpoint::hash(options.str());
+    checkpoint.reset(new TwiddleCheckpoint(checkpoint_file, checkpoint_interval));
+    if (std::ifstream(checkpoint_file.c_str())) {
+      if (!checkpoint->load()) {
+        std::cerr << "Invalid checkpoint: " << checkpoint_file << std::endl;
+        exit(-1);
+      }
+      if (checkpoint->getOptions() != options_hash) {
+        std::cerr << "The checkpoint was written with other options: " << checkpoint_file << std::endl;
+        exit(-1);
+      }
+    }
+    checkpoint->setOptions(options_hash);
+  }
+  // writes the plot data while tuning goes on
+  std::unique_ptr<TuningRecorder> recorder;
+  if (!plot_dir.empty()) {
+    recorder.reset(new TuningRecorder(plot_dir));
+  }
+
+  // the car of a speed bucket with the options
+  auto makeCar = [&](int v) {
+    double x0 = 0, y0 = y, yaw0 = 0;
+    if (follow_track) {
+      // start y to the left of the first point of the track, heading along the track
+      yaw0 = track.getHeading(0);
+      x0 = track.getX(0) - y * sin(yaw0);
+      y0 = track.getY(0) + y * cos(yaw0);
+    }
+    std::unique_ptr<CarTwiddle> car(new CarTwiddle(length, x0, y0, yaw0, v * 1.61 * 1000 / 3600.0, noise, drift));
+    if (follow_track) {
+      car->setTrack(&track);
+    }
+    car->setDtJitter(jitter);
+    car->setTimedControl(timed, tau, windup);
+    car->setSeed(seed);
+    // the runs on the workers, the runs refined with L-BFGS, and the joint runs in parallel, replay
+    // the noise of the seed
+    car->setCommonNoise(common_noise || !listen_address.empty() || !worker_address.empty() || lbfgs_threshold > 0 ||
+                        joint);
+    car->setBatchedNoise(fast_noise);
+    car->setFastMath(fast_math);
+    car->setIntegrator(integrator);
+    return car;
+  };
+
+  if (!worker_address.empty()) {
+    runWorker(worker_address, TwiddleCheckpoint::hash(car_options.str()), makeCar);
+    return 0;
+  }
+
+  // the coordinator of the workers evaluating the runs
+  std::unique_ptr<Coordinator> coordinator;
+  if (!listen_address.empty()) {
+    coordinator.reset(new Coordinator(TwiddleCheckpoint::hash(car_options.str())));
+    if (!coordinator->listen(listen_address)) {
+      std::cerr << "Failed to listen: " << listen_address << std::endl;
+      exit(-1);
+    }
+  }
+
+  // the threads of the Monte Carlo samples and of the joint batches, shared by the speed buckets
+  std::unique_ptr<ThreadPool> pool;
+  if (samples > 0 || (joint && !coordinator)) {
+    pool.reset(new ThreadPool(threads));
+  }
+
+  // tune the coefficients of a speed bucket
+  auto tuneSpeed = [&](int v, std::ostream &out) {
+    std::unique_ptr<CarTwiddle> tuned_car = makeCar(v);
+    CarTwiddle &car = *tuned_car;
+
+    // tune with the car, with Monte Carlo samples of it, or with the workers, and record the
+    // passes of the twiddle and the trajectory of the tuned car when plotting
+    auto tune = [&](VectorXd &p, double target_value, const std::string &name) {
+      std::vector<Twiddle::Pass> passes;
+      std::vector<Twiddle::Pass> *convergence = recorder? &passes: NULL;
+      std::string key = name + "_" + std::to_string(v);
+      // twiddle the coefficients of a model, in batches of the runs the model runs at once for the
+      // joint mode, or search the box of the mode for them with Bayesian optimization
+      auto optimize = [&](Twiddle &model, double threshold, int parallel_runs) {
+        if (bayes_evaluations <= 0) {
+          return model.twiddleBatch(p, target_value, steps, dt, threshold, joint? parallel_runs: 0, convergence);
+        }
+        VectorXd upper(p.size());
+        if (joint) {
+          upper << Eigen::Map<const VectorXd>(steering_bounds, 3), Eigen::Map<const VectorXd>(accel_bounds, 3);
+        } else {
+          upper = Eigen::Map<const VectorXd>(car.getMode() == car.ACCELERATION_MODE? accel_bounds: steering_bounds, 3);
+        }
+        BayesTuner tuner(-upper, upper, batch, seed);
+        return tuner.tune(model, p, target_value, steps, dt, bayes_evaluations, convergence);
+      };
+      double error;
+      try {
+        if (coordinator) {
+          RemoteTwiddle remote(*coordinator, car, v);
+          remote.setCheckpoint(checkpoint.get(), key);
+          // as many runs at once as workers are connected when the speed bucket starts
+          error = optimize(remote, 0.0001, (int)coordinator->getWorkers());
+        } else if (samples <= 0) {
+          double threshold = lbfgs_threshold > 0? lbfgs_threshold: 0.0001;
+          if (joint) {
+            // the batches run on copies of the car on the threads
+            ParallelTwiddle parallel(car, *pool);
+            error = optimize(parallel, threshold, width);
+          } else {
+            car.setCheckpoint(checkpoint.get(), key);
+            error = optimize(car, threshold, 0);
+          }
+          if (lbfgs_threshold > 0) {
+            // refine the coarse coefficients along the gradients of the runs
+            LBFGS lbfgs;
+            error = lbfgs.minimize([&](const VectorXd &x, VectorXd &gradient) {
+              return car.runGradient(x, target_value, steps, dt, gradient);
+            }, p, convergence);
+          }
+        } else {
+          MonteCarloTwiddle mc(car, *pool, samples, seed, drift_sigma);
+          mc.setRisk(risk);
+          mc.setCheckpoint(checkpoint.get(), key);
+          optimize(mc, 0.0001, 0);
+          // score the tuned coefficients
+          error = mc.run(p, target_value, steps, dt, NULL);
+          const MonteCarloTwiddle::Statistics &statistics = mc.getStatistics();
+          out << "Speed: " << v << ", Samples: " << samples << ", Mean error: " << statistics.mean
+              << ", Variance: " << statistics.variance << ", Worst error: " << statistics.worst
+              << ", Diverged: " << statistics.diverged << std::endl;
+        }
+      } catch (const char *message) {
+        std::cerr << message << ": " << key << ", in " << checkpoint_file << std::endl;
+        exit(-1);
+      }
+      if (recorder) {
+        // record on a copy of the car, so that the noise drawn by the recording run does not shift the
+        // noise of the tunings that follow
+        MemoryTrajectorySink trajectory(2 * steps);
+        CarTwiddle recorded(car);
+        recorded.run(p, target_value, steps, dt, &trajectory);
+        recorder->writeTrajectory(key, trajectory.release());
+        recorder->writeConvergence(key, std::move(passes));
+      }
+      return error;
+    };
 
     VectorXd steering_p(3);
     VectorXd accel_p(3);
-    if (accel) {
+    if (joint) {
+      // the steering and the acceleration coefficients of one run, to the target of the acceleration
+      VectorXd joint_p(6);
+      car.setMode(car.JOINT_MODE);
+      double error = tune(joint_p, v + target * 1.61 * 1000 / 3600.0, "joint");
+      steering_p = joint_p.head(3);
+      accel_p = joint_p.tail(3);
+      out << "Speed: " << v << ", Joint coefficients: " << steering_p[0] << ", " << steering_p[1] << ", " << steering_p[2]
+          << ", " << accel_p[0] << ", " << accel_p[1] << ", " << accel_p[2] << ", Error: " << error << std::endl;
+      if (tune_schedule) {
+        schedule.set((v - 50) / 10, steering_p.data(), accel_p.data());
+      }
+      return;
+    }
+    // the gain schedule needs both the acceleration and the steering coefficients
+    if (accel || tune_schedule) {
       car.setMode(car.ACCELERATION_MODE);
-      double error = car.twiddle(accel_p, v + target * 1.61 * 1000 / 3600.0, steps, dt, 0.0001);
-      std::cout  << "Speed: " << v << ", Acceleration coefficient: " << accel_p[0] << ", " << accel_p[1] << ", " << accel_p[2] << ", Error: " << error << std::endl;
+      double error = tune(accel_p, v + target * 1.61 * 1000 / 3600.0, "acceleration");
+      out << "Speed: " << v << ", Acceleration coefficient: " << accel_p[0] << ", " << accel_p[1] << ", " << accel_p[2] << ", Error: " << error << std::endl;
     }
-    else {
+    if (!accel || tune_schedule) {
       car.setMode(car.STEERING_MODE);
-      double error = car.twiddle(steering_p, target, steps, dt, 0.0001);
-      std::cout << "Speed: " << v << ", Steering coefficients: " << steering_p[0] << ", " << steering_p[1] << ", " << steering_p[2] << ", Error: " << error << std::endl; 
-    }
-#ifdef PLOT_WITH_MATPLOT
-    std::vector<double> x_trajectory{};
-    std::vector<double> y_trajectory{};
-    if (accel) {
-      car.run(accel_p, v + target * 1.61 * 1000 / 3600.0, steps, dt, &x_trajectory, &y_trajectory);
-    } else {
-      car.run(steering_p, target, steps, dt, &x_trajectory, &y_trajectory);
+      double error = tune(steering_p, target, "steering");
+      out << "Speed: " << v << ", Steering coefficients: " << steering_p[0] << ", " << steering_p[1] << ", " << steering_p[2] << ", Error: " << error << std::endl; 
+    }
+    if (tune_schedule) {
+      schedule.set((v - 50) / 10, steering_p.data(), accel_p.data());
+    }
+  };
+
+  if (coordinator) {
+    // the speed buckets share the workers, and their results are printed in order
+    std::vector<std::ostringstream> outs(velocity >= 50? (int(velocity) - 50) / 10 + 1: 0);
+    std::vector<std::thread> buckets;
+    for (int v = 50; v <= velocity; v += 10) {
+      buckets.push_back(std::thread(tuneSpeed, v, std::ref(outs[(v - 50) / 10])));
+    }
+    for (size_t i = 0; i < buckets.size(); i++) {
+      buckets[i].join();
+      std::cout << outs[i].str() << std::flush;
     }
-    std::string plot_specs[] = {"b", "r", "g", "c", "y", "m", "k", "w"};
-    plt::plot(x_trajectory, y_trajectory, plot_specs[(v/10-3)%8]);
-    plt::show();
-#endif
+  } else {
+    for (int v = 50; v <= velocity; v += 10) {
+      tuneSpeed(v, std::cout);
+    }
+  }
+
+  if (recorder && !recorder->wait()) {
+    std::cerr << "Failed to write plot data: " << plot_dir << std::endl;
+    exit(-1);
+  }
+
+  if (tune_schedule && !schedule.save(schedule_file)) {
+    std::cerr << "Failed to write gain schedule: " << schedule_file << std::endl;
+    exit(-1);
   }
 }
 
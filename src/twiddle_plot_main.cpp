@@ -0,0 +1,123 @@
+#include <math.h>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "sim/TrajectorySink.h"
+#include "utils/MappedLog.h"
+#include "matplotlibcpp.h"
+
+namespace plt = matplotlibcpp;
+
+/**
+ * Return true if a string ends with a suffix
+ */
+bool endsWith(const std::string &s, const std::string &suffix) {
+  return s.size() >= suffix.size() && s.compare(s.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+/**
+ * Return the file name of a path without the directories and the extension
+ */
+std::string plotName(const std::string &path) {
+  size_t slash = path.find_last_of('/');
+  std::string name = slash == std::string::npos? path: path.substr(slash + 1);
+  return name.substr(0, name.find('.'));
+}
+
+/**
+ * Read the pass and the least error of every line of a convergence file
+ * @param path the file written by TuningRecorder
+ * @param passes receives the passes
+ * @param errors receives the base 10 logarithm of the least errors
+ * @return true if successful
+ */
+bool loadConvergence(const std::string &path, std::vector<double> &passes, std::vector<double> &errors) {
+  std::ifstream in(path.c_str());
+  std::string line;
+  // skip the header
+  if (!std::getline(in, line)) {
+    return false;
+  }
+  while (std::getline(in, line)) {
+    std::istringstream fields(line);
+    double pass, best;
+    char comma;
+    if (!(fields >> pass >> comma >> best)) {
+      return false;
+    }
+    passes.push_back(pass);
+    errors.push_back(log10(best));
+  }
+  return true;
+}
+
+int main(int argc, char* argv[]) {
+  std::string out = ""; // the prefix of the image files to save, empty to show the plots
+  std::vector<std::string> trajectories; // the trajectory files
+  std::vector<std::string> convergences; // the convergence files
+
+  // Process command line options
+  for (int i = 1; i < argc; i++) {
+    if (std::string((argv[i])) == "-out") { // image files
+      out = argv[++i];
+    } else if (endsWith(argv[i], ".trajectory")) {
+      trajectories.push_back(argv[i]);
+    } else if (endsWith(argv[i], ".convergence.csv")) {
+      convergences.push_back(argv[i]);
+    } else {
+      std::cerr << "Unknown option: " << argv[i] << std::endl;
+      exit(-1);
+    }
+  }
+  if (trajectories.empty() && convergences.empty()) {
+    std::cerr << "Usage: twiddle_plot [-out prefix] file.trajectory... file.convergence.csv..." << std::endl;
+    exit(-1);
+  }
+
+  if (!trajectories.empty()) {
+    plt::figure();
+    for (size_t i = 0; i < trajectories.size(); i++) {
+      MappedLog<TrajectoryPoint> log;
+      if (!log.open(trajectories[i])) {
+        std::cerr << "Invalid trajectory: " << trajectories[i] << std::endl;
+        exit(-1);
+      }
+      std::vector<double> x(log.size()), y(log.size());
+      for (size_t k = 0; k < log.size(); k++) {
+        x[k] = log[k].x;
+        y[k] = log[k].y;
+      }
+      plt::named_plot(plotName(trajectories[i]), x, y);
+    }
+    plt::title("Trajectories");
+    plt::legend();
+    if (!out.empty()) {
+      plt::save(out + "-trajectories.png");
+    }
+  }
+
+  if (!convergences.empty()) {
+    plt::figure();
+    for (size_t i = 0; i < convergences.size(); i++) {
+      std::vector<double> passes, errors;
+      if (!loadConvergence(convergences[i], passes, errors)) {
+        std::cerr << "Invalid convergence: " << convergences[i] << std::endl;
+        exit(-1);
+      }
+      plt::named_plot(plotName(convergences[i]), passes, errors);
+    }
+    plt::title("Convergence");
+    plt::xlabel("pass");
+    plt::ylabel("log10 error");
+    plt::legend();
+    if (!out.empty()) {
+      plt::save(out + "-convergence.png");
+    }
+  }
+
+  if (out.empty()) {
+    plt::show();
+  }
+}
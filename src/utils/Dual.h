@@ -0,0 +1,156 @@
+#ifndef _UTILS_DUAL_H_
+#define _UTILS_DUAL_H_
+
+#include <math.h>
+#include <ostream>
+
+/**
+ * Dual is a forward mode automatic differentiation number: a value and its partial derivatives
+ * with respect to N variables. Arithmetic and the math functions carry the derivatives along by
+ * the chain rule, so a computation templated on the scalar type computes its derivatives with
+ * respect to its variables in the same pass as its value, and the value is the same as that of the
+ * computation on doubles. Comparisons compare the values, so the branches of a computation are
+ * taken as with doubles, and the derivatives are those of the branch taken.
+ */
+template<int N> class Dual {
+public:
+  double value;        // the value
+  double partials[N];  // the partial derivatives with respect to the variables
+
+  /**
+   * Constructor of a constant
+   * @param value the value
+   */
+  Dual(double value = 0): value(value) {
+    for (int k = 0; k < N; k++) {
+      partials[k] = 0;
+    }
+  }
+
+  /**
+   * Return a variable, whose derivative is one with respect to itself and zero to the others
+   * @param value the value of the variable
+   * @param index the index of the variable
+   */
+  static Dual variable(double value, int index) {
+    Dual d(value);
+    d.partials[index] = 1;
+    return d;
+  }
+
+  Dual &operator+=(const Dual &b) {
+    value += b.value;
+    for (int k = 0; k < N; k++) {
+      partials[k] += b.partials[k];
+    }
+    return *this;
+  }
+
+  Dual &operator-=(const Dual &b) {
+    value -= b.value;
+    for (int k = 0; k < N; k++) {
+      partials[k] -= b.partials[k];
+    }
+    return *this;
+  }
+
+  Dual &operator*=(const Dual &b) {
+    for (int k = 0; k < N; k++) {
+      partials[k] = partials[k] * b.value + value * b.partials[k];
+    }
+    value *= b.value;
+    return *this;
+  }
+
+  Dual &operator/=(const Dual &b) {
+    // the value is divided rather than multiplied by the reciprocal, so that it is the same as
+    // that of the computation on doubles
+    value /= b.value;
+    for (int k = 0; k < N; k++) {
+      partials[k] = (partials[k] - value * b.partials[k]) / b.value;
+    }
+    return *this;
+  }
+
+  Dual &operator+=(double b) { value += b; return *this; }
+  Dual &operator-=(double b) { value -= b; return *this; }
+
+  Dual &operator*=(double b) {
+    value *= b;
+    for (int k = 0; k < N; k++) {
+      partials[k] *= b;
+    }
+    return *this;
+  }
+
+  Dual &operator/=(double b) {
+    value /= b;
+    for (int k = 0; k < N; k++) {
+      partials[k] /= b;
+    }
+    return *this;
+  }
+
+  /**
+   * Return the derivatives scaled by a factor, and the value replaced, the chain rule of a function
+   * @param value the value of the function
+   * @param derivative the derivative of the function at the value of this number
+   */
+  Dual chain(double value, double derivative) const {
+    Dual d(value);
+    for (int k = 0; k < N; k++) {
+      d.partials[k] = derivative * partials[k];
+    }
+    return d;
+  }
+};
+
+template<int N> inline Dual<N> operator-(const Dual<N> &a) { return a.chain(-a.value, -1); }
+
+template<int N> inline Dual<N> operator+(Dual<N> a, const Dual<N> &b) { return a += b; }
+template<int N> inline Dual<N> operator-(Dual<N> a, const Dual<N> &b) { return a -= b; }
+template<int N> inline Dual<N> operator*(Dual<N> a, const Dual<N> &b) { return a *= b; }
+template<int N> inline Dual<N> operator/(Dual<N> a, const Dual<N> &b) { return a /= b; }
+
+template<int N> inline Dual<N> operator+(Dual<N> a, double b) { return a += b; }
+template<int N> inline Dual<N> operator-(Dual<N> a, double b) { return a -= b; }
+template<int N> inline Dual<N> operator*(Dual<N> a, double b) { return a *= b; }
+template<int N> inline Dual<N> operator/(Dual<N> a, double b) { return a /= b; }
+
+template<int N> inline Dual<N> operator+(double a, Dual<N> b) { return b += a; }
+template<int N> inline Dual<N> operator-(double a, const Dual<N> &b) { return -b + a; }
+template<int N> inline Dual<N> operator*(double a, Dual<N> b) { return b *= a; }
+template<int N> inline Dual<N> operator/(double a, const Dual<N> &b) { return Dual<N>(a) /= b; }
+
+template<int N> inline bool operator<(const Dual<N> &a, const Dual<N> &b) { return a.value < b.value; }
+template<int N> inline bool operator>(const Dual<N> &a, const Dual<N> &b) { return a.value > b.value; }
+template<int N> inline bool operator<=(const Dual<N> &a, const Dual<N> &b) { return a.value <= b.value; }
+template<int N> inline bool operator>=(const Dual<N> &a, const Dual<N> &b) { return a.value >= b.value; }
+template<int N> inline bool operator==(const Dual<N> &a, const Dual<N> &b) { return a.value == b.value; }
+template<int N> inline bool operator!=(const Dual<N> &a, const Dual<N> &b) { return a.value != b.value; }
+
+template<int N> inline bool operator<(const Dual<N> &a, double b) { return a.value < b; }
+template<int N> inline bool operator>(const Dual<N> &a, double b) { return a.value > b; }
+template<int N> inline bool operator<=(const Dual<N> &a, double b) { return a.value <= b; }
+template<int N> inline bool operator>=(const Dual<N> &a, double b) { return a.value >= b; }
+template<int N> inline bool operator<(double a, const Dual<N> &b) { return a < b.value; }
+template<int N> inline bool operator>(double a, const Dual<N> &b) { return a > b.value; }
+
+template<int N> inline Dual<N> sin(const Dual<N> &a) { return a.chain(::sin(a.value), ::cos(a.value)); }
+template<int N> inline Dual<N> cos(const Dual<N> &a) { return a.chain(::cos(a.value), -::sin(a.value)); }
+
+template<int N> inline Dual<N> tan(const Dual<N> &a) {
+  double t = ::tan(a.value);
+  return a.chain(t, 1 + t * t);
+}
+
+template<int N> inline Dual<N> sqrt(const Dual<N> &a) {
+  double s = ::sqrt(a.value);
+  return a.chain(s, 0.5 / s);
+}
+
+template<int N> inline Dual<N> fabs(const Dual<N> &a) { return a.value < 0? -a: a; }
+
+template<int N> inline std::ostream &operator<<(std::ostream &out, const Dual<N> &a) { return out << a.value; }
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef _UTILS_FASTMATH_H_
+#define _UTILS_FASTMATH_H_
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+// Approximations of elementary functions with bounded error, for inner loops that are run millions
+// of times or vectorized. They take no calls, and the logarithm, the sine and cosine, and the angle
+// wrapping are branch free, so loops using them are vectorized when built with -fno-math-errno.
+// The tangent branches to skip the reduction of small angles.
+
+// 1.5 * 2^52, adding and subtracting it rounds a double of magnitude below 2^51 to the nearest
+// integer, as the sum is in [2^52, 2^53) where the doubles are the integers
+#define FAST_MATH_ROUND 6755399441055744.0
+
+/**
+ * Return a double with the given bits
+ */
+inline double asDouble(uint64_t bits) {
+  double d;
+  memcpy(&d, &bits, sizeof(d));
+  return d;
+}
+
+/**
+ * Return the bits of a double
+ */
+inline uint64_t asBits(double d) {
+  uint64_t bits;
+  memcpy(&bits, &d, sizeof(bits));
+  return bits;
+}
+
+/**
+ * Return the natural logarithm of a positive normal number, with a relative error below 2e-12.
+ * The number is split into a power of 2 and a mantissa in [sqrt(2)/2, sqrt(2)), by offsetting the
+ * bits so that the exponent steps at sqrt(2)/2, and the logarithm of the mantissa is the series of
+ * atanh((m - 1) / (m + 1))
+ * @param x the number
+ */
+inline double fastLog(double x) {
+  const uint64_t ONE = 0x3ff0000000000000ULL;
+  const uint64_t HALF_SQRT2 = 0x3fe6a09e667f3bcdULL;
+  uint64_t bits = asBits(x) + (ONE - HALF_SQRT2);
+  double m = asDouble((bits & 0x000fffffffffffffULL) + HALF_SQRT2);
+  // the exponent as a double with integer operations only, which vectorize
+  double e = asDouble(0x4330000000000000ULL | (bits >> 52)) - (4503599627370496.0 + 1023);
+  double f = (m - 1) / (m + 1);
+  double f2 = f * f;
+  double series = 1 + f2 * (1.0 / 3 + f2 * (1.0 / 5 + f2 * (1.0 / 7 + f2 * (1.0 / 9 + f2 * (1.0 / 11 + f2 * (1.0 / 13))))));
+  return e * M_LN2 + 2 * f * series;
+}
+
+/**
+ * Compute the sine and cosine of a small angle with their Taylor series, with an absolute error
+ * below 2e-15. The series in the square of the angle are evaluated with Estrin's scheme, which is
+ * shallower than Horner's
+ * @param a the angle in radians, in [-pi / 4, pi / 4]
+ * @param s receives the sine
+ * @param c receives the cosine
+ */
+inline void fastSinCosSmall(double a, double &s, double &c) {
+  double a2 = a * a, a4 = a2 * a2, a8 = a4 * a4;
+  s = a + a * a2 * ((-1.0 / 6 + a2 * (1.0 / 120)) + a4 * (-1.0 / 5040 + a2 * (1.0 / 362880)) +
+      a8 * ((-1.0 / 39916800 + a2 * (1.0 / 6227020800)) + a4 * (-1.0 / 1307674368000.0)));
+  c = 1 + a2 * ((-1.0 / 2 + a2 * (1.0 / 24)) + a4 * (-1.0 / 720 + a2 * (1.0 / 40320)) +
+      a8 * ((-1.0 / 3628800 + a2 * (1.0 / 479001600)) + a4 * (-1.0 / 87178291200.0)));
+}
+
+/**
+ * Compute the sine and cosine of an angle, with an absolute error below 2e-15 for angles within
+ * 2^20 of 0. The angle is reduced to [-pi / 4, pi / 4] by the nearest multiple of pi / 2, with pi / 2
+ * split in two parts so that the reduction is exact, and the sine and cosine of the reduced angle
+ * are swapped and negated by the quadrant with bit operations
+ * @param a the angle in radians, of magnitude below 2^27
+ * @param s receives the sine
+ * @param c receives the cosine
+ */
+inline void fastSinCos(double a, double &s, double &c) {
+  // pi / 2 as a part with the last 27 bits of the mantissa zero, whose multiples are exact, and the rest
+  const double PI_2_HIGH = 1.5707963109016418, PI_2_LOW = 1.5893254773528196e-08;
+  double rounded = a * M_2_PI + FAST_MATH_ROUND;
+  // the last bits of the sum are those of the nearest quadrant
+  uint64_t quadrant = asBits(rounded);
+  double q = rounded - FAST_MATH_ROUND;
+  double sin_r, cos_r;
+  fastSinCosSmall((a - q * PI_2_HIGH) - q * PI_2_LOW, sin_r, cos_r);
+  // sin(r + q * pi / 2) is sin r, cos r, -sin r, -cos r for the quadrants 0 to 3, selected by masks
+  uint64_t odd = 0 - (quadrant & 1);
+  uint64_t sin_bits = asBits(sin_r), cos_bits = asBits(cos_r);
+  s = asDouble(((sin_bits & ~odd) | (cos_bits & odd)) ^ ((quadrant & 2) << 62));
+  c = asDouble(((cos_bits & ~odd) | (sin_bits & odd)) ^ (((quadrant + 1) & 2) << 62));
+}
+
+/**
+ * Compute the sine and cosine of an angle given in turns
+ * @param turns the angle in turns, of magnitude below 2^24
+ * @param s receives the sine
+ * @param c receives the cosine
+ */
+inline void fastSinCosTurns(double turns, double &s, double &c) {
+  fastSinCos(turns * (2 * M_PI), s, c);
+}
+
+/**
+ * Return the tangent of an angle, with a relative error below 2e-15 for angles within 1.5 of 0.
+ * The sine and cosine of angles within pi / 4 of 0 need no reduction, so they are computed
+ * without it on a branch
+ * @param a the angle in radians
+ */
+inline double fastTan(double a) {
+  double s, c;
+  if (fabs(a) <= M_PI_4) {
+    fastSinCosSmall(a, s, c);
+  } else {
+    fastSinCos(a, s, c);
+  }
+  return s / c;
+}
+
+/**
+ * Wrap an angle to [-pi, pi] without loops, unlike normalizeAngle, pi may be returned for -pi
+ * @param a the angle in radians, of magnitude below 2^51
+ */
+inline double wrapAngle(double a) {
+  double turns = a * (0.5 / M_PI);
+  return a - ((turns + FAST_MATH_ROUND) - FAST_MATH_ROUND) * (2 * M_PI);
+}
+
+#endif
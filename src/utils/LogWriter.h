@@ -0,0 +1,89 @@
+#ifndef _UTILS_LOGWRITER_H_
+#define _UTILS_LOGWRITER_H_
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * LogWriter writes a log of fixed size binary records which can be read by MappedLog, see
+ * MappedLog for the format.
+ */
+template<typename T> class LogWriter {
+  static_assert(is_trivially_copyable<T>::value, "log records must be trivially copyable");
+
+  // the log file
+  FILE *file;
+
+public:
+  LogWriter(): file(NULL) {}
+
+  ~LogWriter() { close(); }
+
+  LogWriter(const LogWriter &) = delete;
+  LogWriter &operator=(const LogWriter &) = delete;
+
+  /**
+   * Create a log file, an existing file is overwritten
+   * @param path the file path
+   * @return true if successful
+   */
+  bool open(const string &path) {
+    close();
+    file = fopen(path.c_str(), "wb");
+    if (!file) {
+      return false;
+    }
+    uint32_t record_size = sizeof(T);
+    if (fwrite("RLOG", 4, 1, file) != 1 || fwrite(&record_size, sizeof(record_size), 1, file) != 1) {
+      close();
+      return false;
+    }
+    return true;
+  }
+
+  /**
+   * Return true if the log is open
+   */
+  bool isOpen() const { return file != NULL; }
+
+  /**
+   * Append a record
+   * @param record the record
+   * @return true if successful
+   */
+  bool append(const T &record) {
+    return fwrite(&record, sizeof(T), 1, file) == 1;
+  }
+
+  /**
+   * Append records
+   * @param records the records
+   * @param count number of records
+   * @return true if successful
+   */
+  bool append(const T *records, size_t count) {
+    return fwrite(records, sizeof(T), count, file) == count;
+  }
+
+  /**
+   * Flush the buffered records to the file
+   */
+  bool flush() { return fflush(file) == 0; }
+
+  /**
+   * Close the log
+   * @return true if all the records were written
+   */
+  bool close() {
+    bool ok = true;
+    if (file) {
+      ok = fclose(file) == 0;
+    }
+    file = NULL;
+    return ok;
+  }
+};
+#endif
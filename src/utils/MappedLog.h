@@ -0,0 +1,107 @@
+#ifndef _UTILS_MAPPEDLOG_H_
+#define _UTILS_MAPPEDLOG_H_
+#include <fcntl.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+#include <type_traits>
+
+using namespace std;
+
+/**
+ * MappedLog reads a log of fixed size binary records written by LogWriter. The file is memory
+ * mapped, so the records are read in place without copying or parsing, and the kernel reads the
+ * file ahead as the records are scanned.
+ * A log has an 8 byte header, the magic "RLOG" and the record size as a 32 bit unsigned integer,
+ * followed by the records in the native layout, so the number of records is derived from the
+ * file size, and a log that is still being written can be read up to its last complete record.
+ */
+template<typename T> class MappedLog {
+  static_assert(is_trivially_copyable<T>::value, "log records must be trivially copyable");
+
+  // the mapped file
+  void *mapped;
+  // size of the mapped file
+  size_t length;
+  // number of records
+  size_t count;
+
+public:
+  // size of the header
+  static const size_t HEADER_SIZE = 8;
+
+  MappedLog(): mapped(NULL), length(0), count(0) {}
+
+  ~MappedLog() { close(); }
+
+  MappedLog(const MappedLog &) = delete;
+  MappedLog &operator=(const MappedLog &) = delete;
+
+  /**
+   * Map a log file
+   * @param path the file path
+   * @return true if successful, false if the file can not be mapped, or it is not a log of T
+   */
+  bool open(const string &path) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)HEADER_SIZE) {
+      ::close(fd);
+      return false;
+    }
+    void *p = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+      return false;
+    }
+    const char *header = (const char *)p;
+    uint32_t record_size;
+    memcpy(&record_size, header + 4, sizeof(record_size));
+    if (memcmp(header, "RLOG", 4) != 0 || record_size != sizeof(T)) {
+      munmap(p, st.st_size);
+      return false;
+    }
+    // the records are scanned once from the start to the end
+    madvise(p, st.st_size, MADV_SEQUENTIAL);
+    mapped = p;
+    length = st.st_size;
+    count = (length - HEADER_SIZE) / sizeof(T);
+    return true;
+  }
+
+  /**
+   * Unmap the file
+   */
+  void close() {
+    if (mapped) {
+      munmap(mapped, length);
+    }
+    mapped = NULL;
+    length = 0;
+    count = 0;
+  }
+
+  /**
+   * Return the number of records
+   */
+  size_t size() const { return count; }
+
+  /**
+   * Return the records
+   */
+  const T *data() const { return (const T *)((const char *)mapped + HEADER_SIZE); }
+
+  /**
+   * Return a record
+   * @param i index of the record
+   */
+  const T &operator[](size_t i) const { return data()[i]; }
+};
+#endif
@@ -0,0 +1,31 @@
+#ifndef _UTILS_MATHUTILS_H_
+#define _UTILS_MATHUTILS_H_
+#include <math.h>
+
+// For converting back and forth between radians and degrees.
+
+inline double deg2rad(double x) { return x * M_PI / 180; }
+inline double rad2deg(double x) { return x * 180 / M_PI; }
+
+/**
+ * Normalize an angle to [-pi, pi), of any scalar type that compares with and adds doubles
+ * @param a the angle in radians
+ */
+template<typename T> inline T normalizeAngle(T a) {
+  while (a >= M_PI) a -= 2. * M_PI;
+  while (a < -M_PI) a += 2. * M_PI;
+  return a;
+}
+
+/**
+ * Clamp a to min and max range
+ * @param a the value to clamp
+ * @param min the minimal value
+ * @param max the maximal value
+ * @retur the clampped value
+ */
+template<typename T> inline T clamp(const T a, const T min, const T max) {
+  return a < min? min: (a > max? max: a);
+}
+
+#endif
@@ -0,0 +1,90 @@
+#include <math.h>
+#include <string.h>
+#include "FastMath.h"
+#include "NormalGenerator.h"
+
+/**
+ * Return the next number of a splitmix64 generator, to seed the state
+ * @param x the state of the splitmix64 generator
+ */
+static inline uint64_t splitmix64(uint64_t &x) {
+  uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+  z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+  return z ^ (z >> 31);
+}
+
+// the generators stepped side by side, with a vector extension so that they are stepped in vector
+// registers on any target
+typedef uint64_t Lanes __attribute__((vector_size(sizeof(uint64_t) * NormalGenerator::LANES)));
+
+// the bits of 1.0
+static const uint64_t ONE = 0x3ff0000000000000ULL;
+
+NormalGenerator::NormalGenerator(uint64_t seed) {
+  this->seed(seed);
+}
+
+void NormalGenerator::seed(uint64_t seed) {
+  uint64_t x = seed;
+  for (int lane = 0; lane < LANES; lane++) {
+    for (int w = 0; w < 4; w++) {
+      state[w][lane] = splitmix64(x);
+    }
+  }
+  next = BLOCK;
+}
+
+void NormalGenerator::uniforms(uint64_t *bits) {
+  Lanes s0, s1, s2, s3;
+  memcpy(&s0, state[0], sizeof(s0));
+  memcpy(&s1, state[1], sizeof(s1));
+  memcpy(&s2, state[2], sizeof(s2));
+  memcpy(&s3, state[3], sizeof(s3));
+  for (int i = 0; i < BLOCK; i += LANES) {
+    Lanes a = s0 + s3;
+    Lanes result = ((a << 23) | (a >> 41)) + s0;
+    memcpy(bits + i, &result, sizeof(result));
+    Lanes t = s1 << 17;
+    s2 ^= s0;
+    s3 ^= s1;
+    s1 ^= s2;
+    s0 ^= s3;
+    s2 ^= t;
+    s3 = (s3 << 45) | (s3 >> 19);
+  }
+  memcpy(state[0], &s0, sizeof(s0));
+  memcpy(state[1], &s1, sizeof(s1));
+  memcpy(state[2], &s2, sizeof(s2));
+  memcpy(state[3], &s3, sizeof(s3));
+}
+
+void NormalGenerator::refill() {
+  uint64_t bits[BLOCK];
+  uniforms(bits);
+  for (int i = 0; i < BLOCK; i += 2) {
+    // the top 52 bits as the mantissa of a double in [1, 2), u in (0, 1] so that the log is finite,
+    // v in [0, 1). The loop has no branches and no calls, so it is vectorized
+    double u = 2 - asDouble((bits[i] >> 12) | ONE);
+    double v = asDouble((bits[i + 1] >> 12) | ONE) - 1;
+    double r = sqrt(-2 * fastLog(u));
+    double s, c;
+    fastSinCosTurns(v, s, c);
+    block[i] = r * c;
+    block[i + 1] = r * s;
+  }
+  next = 0;
+}
+
+void NormalGenerator::fill(double *out, size_t n) {
+  while (n > 0) {
+    if (next == BLOCK) {
+      refill();
+    }
+    size_t count = (size_t)(BLOCK - next) < n? BLOCK - next: n;
+    memcpy(out, block + next, count * sizeof(double));
+    next += (int)count;
+    out += count;
+    n -= count;
+  }
+}
@@ -0,0 +1,83 @@
+#ifndef _UTILS_NORMALGENERATOR_H_
+#define _UTILS_NORMALGENERATOR_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+using namespace std;
+
+/**
+ * NormalGenerator draws standard normal variates in blocks, for the noise of simulated steps.
+ * A block of uniform numbers is drawn from LANES independent xoshiro256++ generators stepped
+ * side by side in vector registers, and the uniforms are turned into normal variates pairwise with
+ * the Box-Muller transform. Unlike the polar method of normal_distribution it rejects nothing, and
+ * its logarithm, sine and cosine are branch free polynomial approximations, accurate to 2e-12, so
+ * the transform of a block is vectorized too.
+ * The variates are handed out from the block until it runs out. The generator is seeded with
+ * splitmix64, so every seed, including 0, gives a valid state.
+ */
+class NormalGenerator {
+public:
+  // number of generators stepped side by side
+  static const int LANES = 4;
+  // number of variates in a block, a multiple of 2 * LANES
+  static const int BLOCK = 256;
+
+private:
+  // the four state words of every generator, lane by lane
+  uint64_t state[4][LANES];
+  // the current block of variates
+  double block[BLOCK];
+  // the next variate of the block to hand out
+  int next;
+
+  /**
+   * Draw a block of uniform 64 bit numbers
+   * @param bits receives BLOCK numbers
+   */
+  void uniforms(uint64_t *bits);
+
+  /**
+   * Draw the next block of variates
+   */
+  void refill();
+
+public:
+  /**
+   * Constructor
+   * @param seed the seed
+   */
+  explicit NormalGenerator(uint64_t seed = 1);
+
+  /**
+   * Seed the generator, and discard the rest of the block
+   * @param seed the seed
+   */
+  void seed(uint64_t seed);
+
+  /**
+   * Return the next standard normal variate
+   */
+  double operator()() {
+    if (next == BLOCK) {
+      refill();
+    }
+    return block[next++];
+  }
+
+  /**
+   * Return the next normal variate with a standard deviation
+   * @param sigma the standard deviation
+   */
+  double operator()(double sigma) { return sigma * (*this)(); }
+
+  /**
+   * Fill an array with the next standard normal variates, the same as calling the generator for
+   * each of them
+   * @param out the array
+   * @param n number of variates
+   */
+  void fill(double *out, size_t n);
+};
+
+#endif
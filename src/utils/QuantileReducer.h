@@ -0,0 +1,125 @@
+#ifndef _UTILS_QUANTILEREDUCER_H_
+#define _UTILS_QUANTILEREDUCER_H_
+#include <deque>
+#include <set>
+
+using namespace std;
+
+/**
+ * QuantileReducer maintains a quantile (median, p95, ...) of a sliding window of samples.
+ * It takes samples the same way as Reducer does, but instead of scanning the window on every
+ * query, the window is split into two sorted halves: the lower half holds the samples up to
+ * the quantile, the upper half holds the rest. Every push inserts one sample and evicts at
+ * most one, so the halves are rebalanced with O(log n) work, and the quantile is read in O(1).
+ * The quantile is the nearest rank (lower) quantile, i.e. element floor(q * (n - 1)) of the
+ * sorted window.
+ */
+template<typename T> class QuantileReducer {
+  // size of the samples to reduce
+  size_t limit;
+  // the quantile to maintain, in [0, 1]
+  double q;
+  // total samples received so far
+  long long total_samples;
+  // samples in arrival order, used to evict the oldest sample
+  deque<T> queue;
+  // samples less than or equal to the quantile, the quantile is the largest one
+  multiset<T> low;
+  // samples greater than or equal to the quantile
+  multiset<T> high;
+
+  /**
+   * Rebalance the two halves so that the lower half holds floor(q * (n - 1)) + 1 samples
+   */
+  void rebalance() {
+    size_t target = queue.size() > 0? size_t(q * (queue.size() - 1)) + 1: 0;
+    while (low.size() > target) {
+      typename multiset<T>::iterator last = --low.end();
+      high.insert(*last);
+      low.erase(last);
+    }
+    while (low.size() < target) {
+      typename multiset<T>::iterator first = high.begin();
+      low.insert(*first);
+      high.erase(first);
+    }
+  }
+
+public:
+  /**
+   * Constructor
+   * @param size_limit size of the sliding window
+   * @param quantile the quantile to maintain, 0.5 for median
+   */
+  QuantileReducer(int size_limit, double quantile = 0.5):
+    limit(size_limit), q(quantile < 0? 0: (quantile > 1? 1: quantile)), total_samples(0) {};
+
+  int getLimit() { return int(limit);}
+
+  /**
+   * Return the quantile maintained by the reducer
+   */
+  double getQuantile() { return q;}
+
+  void push(const T &v) {
+    total_samples++;
+    queue.push_back(v);
+    if (low.empty() || !(*low.rbegin() < v)) {
+      low.insert(v);
+    } else {
+      high.insert(v);
+    }
+    if (queue.size() > limit) {
+      const T &old = queue.front();
+      typename multiset<T>::iterator it = low.find(old);
+      if (it != low.end()) {
+        low.erase(it);
+      } else {
+        high.erase(high.find(old));
+      }
+      queue.pop_front();
+    }
+    rebalance();
+  };
+
+  /**
+   * Return size of the reducer which is the number of samples to reduce
+   */
+  int size() { return queue.size();}
+
+  /**
+   * Return the total number of samples to received so far
+   */
+  long long getNumberOfSamplesReceived() { return total_samples;}
+
+  /**
+   * Return the quantile of the samples
+   */
+  T quantile() {
+    if (low.size() > 0) {
+      return *low.rbegin();
+    }
+    return 0;
+  }
+
+  /**
+   * Return max
+   */
+  T max() {
+    if (high.size() > 0) {
+      return *high.rbegin();
+    }
+    return quantile();
+  }
+
+  /**
+   * Return min
+   */
+  T min() {
+    if (low.size() > 0) {
+      return *low.begin();
+    }
+    return 0;
+  }
+};
+#endif
@@ -0,0 +1,105 @@
+#ifndef _UTILS_RCUPOINTER_H_
+#define _UTILS_RCUPOINTER_H_
+#include <atomic>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * RcuPointer publishes immutable snapshots of a value to a single reader thread in the read-copy-update
+ * style. The reader gets the current snapshot with a single atomic load, uses it for a cycle, e.g. one
+ * control cycle, then reports a quiescent state. Writers, which may run on any thread, publish a new
+ * snapshot with an atomic pointer swap, so the reader never waits and never sees a partially updated
+ * value. A replaced snapshot is deleted only after the reader has reported a quiescent state since
+ * the replacement, as the reader may still be using it until then.
+ */
+template<typename T> class RcuPointer {
+  // the current snapshot
+  atomic<T *> current;
+  // number of quiescent states reported by the reader
+  atomic<unsigned long long> epoch;
+  // serializes the writers
+  mutex writer;
+  // replaced snapshots, and the epoch when they were replaced
+  vector<pair<T *, unsigned long long> > retired;
+
+  /**
+   * Delete the retired snapshots that the reader can no longer use, the writer lock must be held
+   */
+  void reclaim() {
+    unsigned long long now = epoch.load();
+    size_t kept = 0;
+    for (size_t i = 0; i < retired.size(); i++) {
+      if (retired[i].second < now) {
+        delete retired[i].first;
+      } else {
+        retired[kept++] = retired[i];
+      }
+    }
+    retired.resize(kept);
+  }
+
+  /**
+   * Replace the current snapshot, the writer lock must be held
+   */
+  void replace(T *value) {
+    T *old = current.exchange(value);
+    // the reader may be using the old snapshot until its next quiescent state
+    retired.push_back(make_pair(old, epoch.load()));
+    reclaim();
+  }
+
+public:
+  /**
+   * Constructor
+   * @param value the initial snapshot, the RcuPointer takes the ownership
+   */
+  RcuPointer(T *value): current(value), epoch(0) {}
+
+  ~RcuPointer() {
+    delete current.load();
+    for (size_t i = 0; i < retired.size(); i++) {
+      delete retired[i].first;
+    }
+  }
+
+  /**
+   * Return the current snapshot. Only the reader thread may call this, and it must not use the
+   * snapshot after calling quiescent()
+   */
+  const T *read() const { return current.load(memory_order_acquire); }
+
+  /**
+   * Report that the reader holds no snapshot, only the reader thread may call this
+   */
+  void quiescent() { epoch.fetch_add(1, memory_order_release); }
+
+  /**
+   * Publish a new snapshot, may be called on any thread
+   * @param value the new snapshot, the RcuPointer takes the ownership
+   */
+  void publish(T *value) {
+    lock_guard<mutex> lock(writer);
+    replace(value);
+  }
+
+  /**
+   * Publish a modified copy of the current snapshot, may be called on any thread. Concurrent
+   * updates are serialized, so none of them is lost
+   * @param modify the function to modify the copy, it returns false to discard the copy
+   * @return true if the modified copy was published
+   */
+  template<typename F> bool update(F modify) {
+    lock_guard<mutex> lock(writer);
+    T *value = new T(*current.load());
+    if (!modify(*value)) {
+      delete value;
+      return false;
+    }
+    replace(value);
+    return true;
+  }
+};
+#endif
@@ -0,0 +1,187 @@
+#include <errno.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include "Socket.h"
+
+/**
+ * Split an address into a Unix domain socket path, or a host and a port
+ * @return true if the address is of a Unix domain socket
+ */
+static bool parseAddress(const string &address, string &path, string &host, string &port) {
+  if (address.compare(0, 5, "unix:") == 0) {
+    path = address.substr(5);
+    return true;
+  }
+  size_t colon = address.find_last_of(':');
+  host = colon == string::npos? "": address.substr(0, colon);
+  port = colon == string::npos? address: address.substr(colon + 1);
+  return false;
+}
+
+/**
+ * Return a Unix domain socket address, false if the path is too long
+ */
+static bool unixAddress(const string &path, struct sockaddr_un &address) {
+  memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  memcpy(address.sun_path, path.c_str(), path.size());
+  return true;
+}
+
+Socket &Socket::operator=(Socket &&another) {
+  if (this != &another) {
+    close();
+    fd = another.fd;
+    unix_path = another.unix_path;
+    another.fd = -1;
+    another.unix_path.clear();
+  }
+  return *this;
+}
+
+bool Socket::listen(const string &address) {
+  close();
+  string path, host, port;
+  if (parseAddress(address, path, host, port)) {
+    struct sockaddr_un local;
+    if (!unixAddress(path, local)) {
+      return false;
+    }
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    // a socket file left by a killed coordinator is replaced
+    unlink(path.c_str());
+    if (fd < 0 || ::bind(fd, (struct sockaddr *)&local, sizeof(local)) != 0 || ::listen(fd, 64) != 0) {
+      close();
+      return false;
+    }
+    unix_path = path;
+    return true;
+  }
+  struct addrinfo hints, *found;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  hints.ai_flags = AI_PASSIVE;
+  if (getaddrinfo(host.empty()? NULL: host.c_str(), port.c_str(), &hints, &found) != 0) {
+    return false;
+  }
+  for (struct addrinfo *a = found; a && fd < 0; a = a->ai_next) {
+    fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    int reuse = 1;
+    if (fd >= 0 && (setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse)) != 0 ||
+                    ::bind(fd, a->ai_addr, a->ai_addrlen) != 0 || ::listen(fd, 64) != 0)) {
+      close();
+    }
+  }
+  freeaddrinfo(found);
+  return fd >= 0;
+}
+
+bool Socket::accept(Socket &client) {
+  client.close();
+  while (true) {
+    int accepted = ::accept(fd, NULL, NULL);
+    if (accepted >= 0) {
+      int nodelay = 1;
+      setsockopt(accepted, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+      client.fd = accepted;
+      return true;
+    }
+    if (errno != EINTR && errno != ECONNABORTED) {
+      return false;
+    }
+  }
+}
+
+bool Socket::connect(const string &address) {
+  close();
+  string path, host, port;
+  if (parseAddress(address, path, host, port)) {
+    struct sockaddr_un remote;
+    if (!unixAddress(path, remote)) {
+      return false;
+    }
+    fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, (struct sockaddr *)&remote, sizeof(remote)) != 0) {
+      close();
+      return false;
+    }
+    return true;
+  }
+  struct addrinfo hints, *found;
+  memset(&hints, 0, sizeof(hints));
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  if (getaddrinfo(host.empty()? "localhost": host.c_str(), port.c_str(), &hints, &found) != 0) {
+    return false;
+  }
+  for (struct addrinfo *a = found; a && fd < 0; a = a->ai_next) {
+    fd = ::socket(a->ai_family, a->ai_socktype, a->ai_protocol);
+    if (fd >= 0 && ::connect(fd, a->ai_addr, a->ai_addrlen) != 0) {
+      close();
+    }
+  }
+  freeaddrinfo(found);
+  if (fd >= 0) {
+    int nodelay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+  }
+  return fd >= 0;
+}
+
+bool Socket::send(const void *data, size_t size) {
+  const char *bytes = (const char *)data;
+  while (size > 0) {
+    ssize_t sent = ::send(fd, bytes, size, MSG_NOSIGNAL);
+    if (sent < 0 && errno == EINTR) {
+      continue;
+    }
+    if (sent <= 0) {
+      return false;
+    }
+    bytes += sent;
+    size -= sent;
+  }
+  return true;
+}
+
+bool Socket::receive(void *data, size_t size) {
+  char *bytes = (char *)data;
+  while (size > 0) {
+    ssize_t received = ::recv(fd, bytes, size, 0);
+    if (received < 0 && errno == EINTR) {
+      continue;
+    }
+    if (received <= 0) {
+      return false;
+    }
+    bytes += received;
+    size -= received;
+  }
+  return true;
+}
+
+void Socket::shutdown() {
+  if (fd >= 0) {
+    ::shutdown(fd, SHUT_RDWR);
+  }
+}
+
+void Socket::close() {
+  if (fd >= 0) {
+    ::close(fd);
+  }
+  if (!unix_path.empty()) {
+    unlink(unix_path.c_str());
+  }
+  fd = -1;
+  unix_path.clear();
+}
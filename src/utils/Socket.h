@@ -0,0 +1,89 @@
+#ifndef _UTILS_SOCKET_H_
+#define _UTILS_SOCKET_H_
+
+#include <stddef.h>
+#include <string>
+
+using namespace std;
+
+/**
+ * Socket is a blocking stream socket, a Unix domain socket for addresses of the form unix:path,
+ * or a TCP socket for addresses of the form host:port. TCP sockets send small messages right away
+ * instead of delaying them to coalesce them. The socket is closed when it is destroyed.
+ */
+class Socket {
+  // the file descriptor, -1 if not open
+  int fd;
+  // the path of the listening Unix domain socket, removed when closed
+  string unix_path;
+
+public:
+  Socket(): fd(-1) {}
+
+  ~Socket() { close(); }
+
+  Socket(const Socket &) = delete;
+  Socket &operator=(const Socket &) = delete;
+
+  Socket(Socket &&another): fd(another.fd), unix_path(another.unix_path) {
+    another.fd = -1;
+    another.unix_path.clear();
+  }
+
+  Socket &operator=(Socket &&another);
+
+  /**
+   * Listen for connections
+   * @param address unix:path or host:port, host can be empty for all the interfaces
+   * @return true if successful
+   */
+  bool listen(const string &address);
+
+  /**
+   * Wait for a connection
+   * @param client receives the connection
+   * @return true if successful, false if the socket is shut down
+   */
+  bool accept(Socket &client);
+
+  /**
+   * Connect to a listening socket
+   * @param address unix:path or host:port
+   * @return true if successful
+   */
+  bool connect(const string &address);
+
+  /**
+   * Return true if the socket is open
+   */
+  bool isOpen() const { return fd >= 0; }
+
+  /**
+   * Send all the bytes of a buffer
+   * @param data the buffer
+   * @param size number of bytes
+   * @return true if successful
+   */
+  bool send(const void *data, size_t size);
+
+  /**
+   * Receive a number of bytes
+   * @param data the buffer to receive the bytes
+   * @param size number of bytes
+   * @return true if successful, false if the connection is closed before
+   */
+  bool receive(void *data, size_t size);
+
+  /**
+   * Shut the socket down, so that calls blocked on it on other threads return, and it can be
+   * closed safely once they have
+   */
+  void shutdown();
+
+  /**
+   * Close the socket
+   */
+  void close();
+};
+
+#endif
@@ -0,0 +1,61 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(size_t threads): pending(0), stopping(false) {
+  if (threads == 0) {
+    threads = thread::hardware_concurrency();
+  }
+  if (threads == 0) {
+    threads = 1;
+  }
+  for (size_t i = 0; i < threads; i++) {
+    workers.push_back(thread(&ThreadPool::work, this));
+  }
+}
+
+ThreadPool::~ThreadPool() {
+  wait();
+  {
+    unique_lock<mutex> guard(lock);
+    stopping = true;
+  }
+  available.notify_all();
+  for (size_t i = 0; i < workers.size(); i++) {
+    workers[i].join();
+  }
+}
+
+void ThreadPool::work() {
+  while (true) {
+    function<void()> task;
+    {
+      unique_lock<mutex> guard(lock);
+      available.wait(guard, [this]() { return stopping || !tasks.empty(); });
+      if (tasks.empty()) {
+        return;
+      }
+      task = move(tasks.front());
+      tasks.pop_front();
+    }
+    task();
+    {
+      unique_lock<mutex> guard(lock);
+      if (--pending == 0) {
+        done.notify_all();
+      }
+    }
+  }
+}
+
+void ThreadPool::submit(function<void()> task) {
+  {
+    unique_lock<mutex> guard(lock);
+    tasks.push_back(move(task));
+    pending++;
+  }
+  available.notify_one();
+}
+
+void ThreadPool::wait() {
+  unique_lock<mutex> guard(lock);
+  done.wait(guard, [this]() { return pending == 0; });
+}
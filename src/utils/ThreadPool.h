@@ -0,0 +1,68 @@
+#ifndef _UTILS_THREADPOOL_H_
+#define _UTILS_THREADPOOL_H_
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/**
+ * ThreadPool runs tasks on a fixed number of worker threads. Tasks are run in the order they are
+ * submitted, and wait() blocks until all the submitted tasks are done. Tasks must not throw.
+ */
+class ThreadPool {
+  // the worker threads
+  vector<thread> workers;
+  // tasks waiting for a worker
+  deque<function<void()> > tasks;
+  // guards the tasks and the counters
+  mutex lock;
+  // signaled when a task is submitted, or the pool is stopping
+  condition_variable available;
+  // signaled when all the tasks are done
+  condition_variable done;
+  // number of tasks submitted but not done
+  size_t pending;
+  // true if the workers are to exit
+  bool stopping;
+
+  /**
+   * The loop of a worker thread
+   */
+  void work();
+
+public:
+  /**
+   * Constructor
+   * @param threads number of worker threads, 0 for the number of hardware threads
+   */
+  ThreadPool(size_t threads = 0);
+
+  /**
+   * Destructor, waits for the submitted tasks and stops the workers
+   */
+  ~ThreadPool();
+
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool &operator=(const ThreadPool &) = delete;
+
+  /**
+   * Return the number of worker threads
+   */
+  size_t size() const { return workers.size(); }
+
+  /**
+   * Submit a task
+   * @param task the task to run on a worker thread
+   */
+  void submit(function<void()> task);
+
+  /**
+   * Wait until all the submitted tasks are done
+   */
+  void wait();
+};
+#endif